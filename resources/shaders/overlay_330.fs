@@ -0,0 +1,67 @@
+#version 330
+
+// Composites the spotlight, darkness, flicker, explosion flash, red flash and teeth in one full-screen pass.
+// Drawn as a screen-sized quad textured with red_flash.png, so fragTexCoord spans the screen.
+
+in vec2 fragTexCoord;
+in vec4 fragColor;
+
+uniform sampler2D texture0;
+uniform sampler2D spotlightTexture;
+uniform sampler2D teethTexture;
+
+uniform vec2 screenSize;
+uniform vec2 lightPosition;
+uniform vec2 lightSize;
+uniform float lightRotation;
+uniform float darkness;
+uniform float flicker;
+uniform float flash;
+uniform float redIntensity;
+uniform vec2 teethTop;
+uniform vec2 teethBottom;
+
+out vec4 finalColor;
+
+// Accumulates premultiplied colour, layering each input over the ones before it
+vec4 over(vec4 below, vec3 color, float alpha) {
+    return vec4(color * alpha + below.rgb * (1.0 - alpha), alpha + below.a * (1.0 - alpha));
+}
+
+bool inside(vec2 uv) {
+    return all(greaterThanEqual(uv, vec2(0.0))) && all(lessThanEqual(uv, vec2(1.0)));
+}
+
+void main() {
+    vec2 position = fragTexCoord * screenSize;
+    vec4 color = vec4(0.0);
+
+    vec2 offset = position - lightPosition;
+    float c = cos(lightRotation);
+    float s = sin(lightRotation);
+    vec2 lightUv = vec2(offset.x * c + offset.y * s, -offset.x * s + offset.y * c) / lightSize + 0.5;
+    if (inside(lightUv)) {
+        vec4 light = texture(spotlightTexture, lightUv);
+        color = over(color, light.rgb, light.a);
+    }
+
+    color = over(color, vec3(0.0), darkness);
+    color = over(color, vec3(0.0), flicker);
+    color = over(color, vec3(1.0), flash);
+
+    vec4 red = texture(texture0, fragTexCoord);
+    color = over(color, red.rgb, red.a * redIntensity);
+
+    vec2 topUv = (position - teethTop) / screenSize;
+    if (inside(topUv)) {
+        vec4 teeth = texture(teethTexture, topUv);
+        color = over(color, teeth.rgb, teeth.a);
+    }
+    vec2 bottomUv = (teethBottom - position) / screenSize;
+    if (inside(bottomUv)) {
+        vec4 teeth = texture(teethTexture, bottomUv);
+        color = over(color, teeth.rgb, teeth.a);
+    }
+
+    finalColor = color.a > 0.0 ? vec4(color.rgb / color.a, color.a) : vec4(0.0);
+}
@@ -0,0 +1,132 @@
+#include "archive.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#define ARCHIVE_MAPPED
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static unsigned char* contents = NULL;
+static size_t contentsSize = 0;
+static const ArchiveEntry* entries = NULL;
+static int entryCount = 0;
+static char root[256];
+static size_t rootLength = 0;
+
+#if defined(ARCHIVE_MAPPED)
+
+static unsigned char* mapFile(const char* path, size_t* size) {
+    int file = open(path, O_RDONLY);
+    if (file < 0) return NULL;
+
+    struct stat info;
+    void* mapping = MAP_FAILED;
+    if (fstat(file, &info) == 0 && info.st_size > 0) {
+        mapping = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+    close(file);
+    if (mapping == MAP_FAILED) return NULL;
+
+    *size = (size_t) info.st_size;
+    return mapping;
+}
+
+static void unmapFile(unsigned char* mapping, size_t size) {
+    munmap(mapping, size);
+}
+
+#else
+
+// Reading the whole archive up front would cost more startup time than it saves, so these builds load loose files
+static unsigned char* mapFile(const char* path, size_t* size) {
+    (void) path;
+    (void) size;
+    return NULL;
+}
+
+static void unmapFile(unsigned char* mapping, size_t size) {
+    (void) mapping;
+    (void) size;
+}
+
+#endif
+
+static bool isValidArchive(void) {
+    if (contentsSize < sizeof(ArchiveHeader)) return false;
+    const ArchiveHeader* header = (const ArchiveHeader*) contents;
+    if (header->magic != ARCHIVE_MAGIC || header->version != ARCHIVE_VERSION) return false;
+    if (header->entryCount > (contentsSize - sizeof(ArchiveHeader)) / sizeof(ArchiveEntry)) return false;
+
+    const ArchiveEntry* table = (const ArchiveEntry*) (contents + sizeof(ArchiveHeader));
+    for (uint32_t i = 0; i < header->entryCount; i++) {
+        const ArchiveEntry* entry = &table[i];
+        if (memchr(entry->name, '\0', ARCHIVE_NAME_SIZE) == NULL) return false;
+        if (entry->offset > contentsSize || entry->size > contentsSize - entry->offset) return false;
+        if (entry->fileSize > entry->size || entry->sampleOffset > entry->size) return false;
+    }
+    return true;
+}
+
+bool OpenArchive(const char* directory) {
+    CloseArchive();
+    const char* path = TextFormat("%s/baked/%s", directory, ARCHIVE_FILE);
+    contents = mapFile(path, &contentsSize);
+    if (contents == NULL) return false;
+
+    if (!isValidArchive()) {
+        TraceLog(LOG_WARNING, "ARCHIVE: [%s] Is not a version %i archive, loading loose files", path, ARCHIVE_VERSION);
+        CloseArchive();
+        return false;
+    }
+
+    entries = (const ArchiveEntry*) (contents + sizeof(ArchiveHeader));
+    entryCount = (int) ((const ArchiveHeader*) contents)->entryCount;
+    rootLength = (size_t) snprintf(root, sizeof(root), "%s/", directory);
+    TraceLog(LOG_INFO, "ARCHIVE: [%s] Opened with %i entries (%i KB)", path, entryCount, (int) (contentsSize / 1024));
+    return true;
+}
+
+void CloseArchive(void) {
+    if (contents != NULL) unmapFile(contents, contentsSize);
+    contents = NULL;
+    contentsSize = 0;
+    entries = NULL;
+    entryCount = 0;
+}
+
+const ArchiveEntry* FindArchiveEntry(const char* path) {
+    if (entries == NULL || strncmp(path, root, rootLength) != 0) return NULL;
+    const char* name = path + rootLength;
+    for (int i = 0; i < entryCount; i++) {
+        if (strcmp(entries[i].name, name) == 0) return &entries[i];
+    }
+    return NULL;
+}
+
+const unsigned char* GetArchivePayload(const ArchiveEntry* entry) {
+    return contents + entry->offset;
+}
+
+void PrefetchArchiveEntry(const ArchiveEntry* entry) {
+    const volatile unsigned char* payload = GetArchivePayload(entry);
+    unsigned char sum = 0;
+    for (uint64_t i = 0; i < entry->size; i += ARCHIVE_ALIGNMENT) sum += payload[i];
+    (void) sum;
+}
+
+void ReleaseArchiveEntry(const ArchiveEntry* entry) {
+#if defined(ARCHIVE_MAPPED) && defined(MADV_DONTNEED)
+    // Only whole pages inside the payload, since pages larger than the alignment can be shared with neighbours
+    size_t pageSize = (size_t) sysconf(_SC_PAGESIZE);
+    uintptr_t begin = ((uintptr_t) GetArchivePayload(entry) + pageSize - 1) / pageSize * pageSize;
+    uintptr_t end = ((uintptr_t) GetArchivePayload(entry) + entry->size) / pageSize * pageSize;
+    if (end > begin) madvise((void*) begin, end - begin, MADV_DONTNEED);
+#else
+    (void) entry;
+#endif
+}
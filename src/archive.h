@@ -0,0 +1,63 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "raylib.h"
+
+#define ARCHIVE_FILE "assets.pak"
+#define ARCHIVE_MAGIC 0x4B415043u
+#define ARCHIVE_VERSION 1
+#define ARCHIVE_ALIGNMENT 4096
+#define ARCHIVE_SAMPLE_ALIGNMENT 16
+#define ARCHIVE_NAME_SIZE 64
+
+// A header, the entry table, then one payload per entry starting on its own page. Little-endian throughout.
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+} ArchiveHeader;
+
+typedef enum {
+    ARCHIVE_IMAGE,
+    ARCHIVE_AUDIO
+} ArchiveEntryKind;
+
+// Images hold pixels ready for upload. Audio holds the original file in its first fileSize bytes, so it can
+// still be streamed; when sampleOffset is not 0, 16-bit samples ready for a sound start there.
+typedef struct {
+    char name[ARCHIVE_NAME_SIZE];
+    uint32_t kind;
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;
+    uint32_t mipmaps;
+    uint32_t frameCount;
+    uint32_t sampleRate;
+    uint32_t sampleSize;
+    uint32_t channels;
+    uint32_t sampleOffset;
+    uint64_t fileSize;
+    uint64_t offset;
+    uint64_t size;
+} ArchiveEntry;
+
+_Static_assert(sizeof(ArchiveEntry) == 128, "archive entries are written as-is");
+
+// Maps directory/baked/assets.pak, whose entries are named by their path below directory
+bool OpenArchive(const char* directory);
+void CloseArchive(void);
+
+// Looks up a path starting with the directory the archive was opened from; NULL when it is not packed
+const ArchiveEntry* FindArchiveEntry(const char* path);
+const unsigned char* GetArchivePayload(const ArchiveEntry* entry);
+
+// Reads the payload in on the calling thread, so that a later upload does not stall on page faults
+void PrefetchArchiveEntry(const ArchiveEntry* entry);
+
+// Hands an uploaded payload's pages back to the OS; they are read from the file again if touched
+void ReleaseArchiveEntry(const ArchiveEntry* entry);
+
+#endif
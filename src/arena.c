@@ -0,0 +1,74 @@
+#include "arena.h"
+
+#include <stdlib.h>
+#include "raylib.h"
+#include "memory.h"
+
+struct ArenaBlock {
+    ArenaBlock* previous;
+    size_t capacity;
+    size_t offset;
+};
+
+#define BLOCK_HEADER_SIZE ((sizeof(ArenaBlock) + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1))
+
+static ArenaBlock* allocateBlock(size_t capacity, ArenaBlock* previous) {
+    ArenaBlock* block = TrackedMalloc(BLOCK_HEADER_SIZE + capacity);
+    if (block == NULL) {
+        TraceLog(LOG_FATAL, "ARENA: Failed to allocate a %zu byte block", capacity);
+        abort();
+    }
+    block->previous = previous;
+    block->capacity = capacity;
+    block->offset = 0;
+    return block;
+}
+
+static size_t freeBlocks(ArenaBlock* block) {
+    size_t capacity = 0;
+    while (block != NULL) {
+        ArenaBlock* previous = block->previous;
+        capacity += block->capacity;
+        TrackedFree(block);
+        block = previous;
+    }
+    return capacity;
+}
+
+void InitArena(Arena* arena, size_t capacity) {
+    arena->block = allocateBlock(capacity, NULL);
+    arena->used = 0;
+    arena->peak = 0;
+}
+
+void UnloadArena(Arena* arena) {
+    freeBlocks(arena->block);
+    arena->block = NULL;
+    arena->used = 0;
+}
+
+void ResetArena(Arena* arena) {
+    if (arena->block->previous != NULL) {
+        arena->block = allocateBlock(freeBlocks(arena->block), NULL);
+    }
+    arena->block->offset = 0;
+    arena->used = 0;
+}
+
+void* ArenaAlloc(Arena* arena, size_t size) {
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t) (ARENA_ALIGNMENT - 1);
+
+    ArenaBlock* block = arena->block;
+    if (block->offset + size > block->capacity) {
+        size_t capacity = block->capacity * 2;
+        while (capacity < size) capacity *= 2;
+        block = allocateBlock(capacity, block);
+        arena->block = block;
+    }
+
+    void* memory = (char*) block + BLOCK_HEADER_SIZE + block->offset;
+    block->offset += size;
+    arena->used += size;
+    if (arena->used > arena->peak) arena->peak = arena->used;
+    return memory;
+}
@@ -0,0 +1,27 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+typedef struct ArenaBlock ArenaBlock;
+
+// Bump allocator that is freed all at once. Allocations past the first block chain extra blocks, which
+// the next reset merges into one, so an arena reused at a steady size stops calling malloc entirely.
+typedef struct {
+    ArenaBlock* block;
+    size_t used;
+    size_t peak;
+} Arena;
+
+#define ARENA_ALIGNMENT _Alignof(max_align_t)
+
+void InitArena(Arena* arena, size_t capacity);
+void UnloadArena(Arena* arena);
+void ResetArena(Arena* arena);
+
+// Returns uninitialized memory, aligned for any type, that stays valid until the next reset
+void* ArenaAlloc(Arena* arena, size_t size);
+
+#define ARENA_ARRAY(arena, type, count) ((type*) ArenaAlloc((arena), sizeof(type) * (count)))
+
+#endif
@@ -0,0 +1,436 @@
+#include "assets.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "archive.h"
+#include "storage.h"
+
+#if !defined(_MSC_VER) && (!defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__))
+#define ASSETS_THREADED
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#endif
+
+#if defined(__EMSCRIPTEN__)
+#define ASSETS_FETCHED
+#include <emscripten/fetch.h>
+#endif
+
+typedef enum {
+    ASSET_TEXTURE,
+    ASSET_SOUND,
+    ASSET_MUSIC
+} AssetKind;
+
+typedef struct {
+    AssetKind kind;
+    AssetStage stage;
+    char path[MAX_ASSET_PATH];
+    void* target;
+    TextureFilter filter;
+    const ArchiveEntry* entry;
+    bool isMapped;
+    bool isRemote;
+    bool isFetched;
+    bool isCached;
+    const char* hash;
+    Image image;
+    Wave wave;
+    unsigned char* data;
+    int dataSize;
+} Asset;
+
+#if defined(ASSETS_THREADED)
+typedef _Atomic bool AssetFlag;
+#else
+typedef bool AssetFlag;
+#endif
+
+static Asset assets[MAX_ASSETS];
+static int assetCount = 0;
+
+// Assets in load order, grouped by stage; decoded and upload progress are tracked by position in this order
+static int order[MAX_ASSETS];
+static AssetFlag isDecoded[MAX_ASSETS];
+static int stageEnds[ASSET_STAGE_COUNT];
+static int nextUpload = 0;
+static bool isStarted = false;
+static double startTime = 0.0;
+
+// Paths the web build downloads in the background rather than preloading, relative to the manifest's directory,
+// with a hash of their contents that names their copy in the cache
+static char* manifest = NULL;
+static const char* remoteNames[MAX_ASSETS];
+static const char* remoteHashes[MAX_ASSETS];
+static int remoteCount = 0;
+static char manifestRoot[MAX_ASSET_PATH];
+static size_t manifestRootLength = 0;
+
+void LoadFetchManifest(const char* directory) {
+    UnloadFileText(manifest);
+    manifest = NULL;
+    remoteCount = 0;
+    const char* path = TextFormat("%s/%s", directory, FETCH_MANIFEST_FILE);
+    if (!FileExists(path)) return;
+
+    manifest = LoadFileText(path);
+    manifestRootLength = (size_t) snprintf(manifestRoot, sizeof(manifestRoot), "%s/", directory);
+    for (char* line = strtok(manifest, "\r\n"); line != NULL && remoteCount < MAX_ASSETS; line = strtok(NULL, "\r\n")) {
+        char* separator = strchr(line, ' ');
+        if (separator == NULL) continue;
+        *separator = '\0';
+        remoteHashes[remoteCount] = line;
+        remoteNames[remoteCount] = separator + 1;
+        remoteCount++;
+    }
+    TraceLog(LOG_INFO, "ASSETS: [%s] %i files are fetched on demand", path, remoteCount);
+}
+
+static const char* findRemoteHash(const char* path) {
+    if (remoteCount == 0 || strncmp(path, manifestRoot, manifestRootLength) != 0) return NULL;
+    for (int i = 0; i < remoteCount; i++) {
+        if (strcmp(remoteNames[i], path + manifestRootLength) == 0) return remoteHashes[i];
+    }
+    return NULL;
+}
+
+static const char* getCachePath(const char* hash) {
+    return GetStoragePath(TextFormat("%s%s", ASSET_CACHE_PREFIX, hash));
+}
+
+bool AssetFileExists(const char* path) {
+    return FileExists(path) || findRemoteHash(path) != NULL;
+}
+
+static Asset* queueAsset(AssetKind kind, void* target, const char* path, AssetStage stage) {
+    if (isStarted || assetCount == MAX_ASSETS || strlen(path) >= MAX_ASSET_PATH) {
+        TraceLog(LOG_WARNING, "ASSETS: [%s] Could not be queued", path);
+        return NULL;
+    }
+
+    Asset* asset = &assets[assetCount++];
+    *asset = (Asset) { .kind = kind, .stage = stage, .target = target, .entry = FindArchiveEntry(path) };
+    if (!FileExists(path)) asset->hash = findRemoteHash(path);
+    asset->isRemote = asset->hash != NULL;
+    strcpy(asset->path, path);
+    return asset;
+}
+
+void QueueTexture(Texture2D* texture, const char* path, AssetStage stage) {
+    queueAsset(ASSET_TEXTURE, texture, path, stage);
+}
+
+void QueueTextureEx(Texture2D* texture, const char* path, AssetStage stage, TextureFilter filter) {
+    Asset* asset = queueAsset(ASSET_TEXTURE, texture, path, stage);
+    if (asset != NULL) asset->filter = filter;
+}
+
+void QueueSound(Sound* sound, const char* path, AssetStage stage) {
+    queueAsset(ASSET_SOUND, sound, path, stage);
+}
+
+void QueueMusic(Music* music, const char* path, AssetStage stage) {
+    queueAsset(ASSET_MUSIC, music, path, stage);
+}
+
+// Packed images and sounds point straight into the archive; only sounds packed as compressed files still decode
+static bool mapAsset(Asset* asset) {
+    const ArchiveEntry* entry = asset->entry;
+    const unsigned char* payload = GetArchivePayload(entry);
+    PrefetchArchiveEntry(entry);
+    asset->isMapped = true;
+
+    if (asset->kind == ASSET_TEXTURE && entry->kind == ARCHIVE_IMAGE) {
+        asset->image = (Image) {
+            .data = (void*) payload,
+            .width = (int) entry->width,
+            .height = (int) entry->height,
+            .mipmaps = (int) entry->mipmaps,
+            .format = (int) entry->format
+        };
+    } else if (asset->kind == ASSET_SOUND && entry->kind == ARCHIVE_AUDIO && entry->sampleOffset != 0) {
+        asset->wave = (Wave) {
+            .frameCount = entry->frameCount,
+            .sampleRate = entry->sampleRate,
+            .sampleSize = entry->sampleSize,
+            .channels = entry->channels,
+            .data = (void*) (payload + entry->sampleOffset)
+        };
+    } else if (asset->kind == ASSET_SOUND && entry->kind == ARCHIVE_AUDIO) {
+        asset->wave = LoadWaveFromMemory(GetFileExtension(asset->path), payload, (int) entry->fileSize);
+        asset->isMapped = false;
+    } else if (asset->kind == ASSET_MUSIC && entry->kind == ARCHIVE_AUDIO) {
+        asset->data = (unsigned char*) payload;
+        asset->dataSize = (int) entry->fileSize;
+    } else {
+        TraceLog(LOG_WARNING, "ASSETS: [%s] Packed as the wrong kind of asset, loading the loose file", asset->path);
+        asset->isMapped = false;
+        return false;
+    }
+    return true;
+}
+
+// Fetched files arrive whole in memory and cached ones are read whole; music keeps them for streaming
+static void decodeFetchedAsset(Asset* asset) {
+    if (asset->isCached) asset->data = LoadFileData(getCachePath(asset->hash), &asset->dataSize);
+    if (asset->kind == ASSET_MUSIC || asset->data == NULL) return;
+
+    if (asset->kind == ASSET_TEXTURE) {
+        asset->image = LoadImageFromMemory(GetFileExtension(asset->path), asset->data, asset->dataSize);
+    } else {
+        asset->wave = LoadWaveFromMemory(GetFileExtension(asset->path), asset->data, asset->dataSize);
+    }
+    UnloadFileData(asset->data);
+    asset->data = NULL;
+}
+
+// Everything here only touches files and CPU memory, so it is safe on any thread
+static void decodeAsset(Asset* asset) {
+    if (asset->isRemote) {
+        decodeFetchedAsset(asset);
+        return;
+    }
+    if (asset->entry != NULL && mapAsset(asset)) return;
+
+    switch (asset->kind) {
+        case ASSET_TEXTURE:
+            asset->image = LoadImage(asset->path);
+            break;
+        case ASSET_SOUND:
+            asset->wave = LoadWave(asset->path);
+            break;
+        case ASSET_MUSIC:
+            asset->data = LoadFileData(asset->path, &asset->dataSize);
+            break;
+    }
+}
+
+static void uploadAsset(Asset* asset) {
+    switch (asset->kind) {
+        case ASSET_TEXTURE: {
+            Texture2D* texture = asset->target;
+            *texture = LoadTextureFromImage(asset->image);
+            if (asset->filter == TEXTURE_FILTER_TRILINEAR && texture->mipmaps == 1) GenTextureMipmaps(texture);
+            if (asset->filter != TEXTURE_FILTER_POINT) SetTextureFilter(*texture, asset->filter);
+            if (asset->isMapped) ReleaseArchiveEntry(asset->entry);
+            else UnloadImage(asset->image);
+            asset->image = (Image) { 0 };
+            break;
+        }
+        case ASSET_SOUND:
+            *(Sound*) asset->target = LoadSoundFromWave(asset->wave);
+            if (asset->isMapped) ReleaseArchiveEntry(asset->entry);
+            else UnloadWave(asset->wave);
+            asset->wave = (Wave) { 0 };
+            break;
+        case ASSET_MUSIC: {
+            if (asset->data == NULL) break;
+            Music* music = asset->target;
+            *music = LoadMusicStreamFromMemory(GetFileExtension(asset->path), asset->data, asset->dataSize);
+            music->looping = true;
+            PlayMusicStream(*music);
+            break;
+        }
+    }
+}
+
+#if defined(ASSETS_THREADED)
+
+static pthread_t loaders[MAX_ASSET_LOADERS];
+static int loaderCount = 0;
+static _Atomic int nextDecode = 0;
+
+static void* loaderMain(void* argument) {
+    (void) argument;
+    for (int i; (i = atomic_fetch_add(&nextDecode, 1)) < assetCount;) {
+        // Fetches complete on the main thread, which then decodes them itself
+        if (assets[order[i]].isRemote) continue;
+        decodeAsset(&assets[order[i]]);
+        isDecoded[i] = true;
+    }
+    return NULL;
+}
+
+// One core is left to the main thread, which keeps rendering while the loaders decode
+static void startLoaders(void) {
+    int requested = (int) sysconf(_SC_NPROCESSORS_ONLN) - 1;
+    if (requested < 1) requested = 1;
+    if (requested > MAX_ASSET_LOADERS) requested = MAX_ASSET_LOADERS;
+
+    nextDecode = 0;
+    for (int i = 0; i < requested; i++) {
+        if (pthread_create(&loaders[i], NULL, loaderMain, NULL) != 0) break;
+        loaderCount++;
+    }
+    if (loaderCount == 0) TraceLog(LOG_WARNING, "ASSETS: No loader threads, decoding on the main thread");
+}
+
+static void stopLoaders(void) {
+    nextDecode = assetCount;
+    for (int i = 0; i < loaderCount; i++) pthread_join(loaders[i], NULL);
+    loaderCount = 0;
+}
+
+#else
+
+static const int loaderCount = 0;
+
+static void startLoaders(void) {
+}
+
+static void stopLoaders(void) {
+}
+
+#endif
+
+#if defined(ASSETS_FETCHED)
+
+static emscripten_fetch_t* fetches[MAX_ASSETS];
+static bool areFetchesStarted = false;
+
+static void fetchFinished(emscripten_fetch_t* fetch) {
+    Asset* asset = fetch->userData;
+    if (fetch->status == 200 && fetch->numBytes > 0) {
+        asset->data = MemAlloc((unsigned int) fetch->numBytes);
+        memcpy(asset->data, fetch->data, fetch->numBytes);
+        asset->dataSize = (int) fetch->numBytes;
+        if (SaveFileData(getCachePath(asset->hash), asset->data, asset->dataSize)) FlushStorage();
+    } else {
+        TraceLog(LOG_WARNING, "ASSETS: [%s] Could not be fetched (status %i)", asset->path, fetch->status);
+    }
+    asset->isFetched = true;
+    fetches[asset - assets] = NULL;
+    emscripten_fetch_close(fetch);
+}
+
+// Cached copies are named by content hash, so a changed asset misses the cache and its old copy is deleted here
+static void pruneCache(void) {
+    FilePathList files = LoadDirectoryFiles(STORAGE_DIRECTORY);
+    size_t prefixLength = strlen(ASSET_CACHE_PREFIX);
+    for (unsigned int i = 0; i < files.count; i++) {
+        const char* name = GetFileName(files.paths[i]);
+        if (strncmp(name, ASSET_CACHE_PREFIX, prefixLength) != 0) continue;
+
+        bool isListed = false;
+        for (int j = 0; j < remoteCount && !isListed; j++) isListed = strcmp(remoteHashes[j], name + prefixLength) == 0;
+        if (!isListed) remove(files.paths[i]);
+    }
+    UnloadDirectoryFiles(files);
+}
+
+// Waits for the cache to be read from IndexedDB. Cached assets are then ready at once; requests for the rest
+// go out in load order, so the browser delivers earlier stages first.
+static void startFetches(void) {
+    if (areFetchesStarted || !IsStorageReady()) return;
+    areFetchesStarted = true;
+    pruneCache();
+
+    int fetchCount = 0;
+    for (int i = 0; i < assetCount; i++) {
+        Asset* asset = &assets[order[i]];
+        if (!asset->isRemote) continue;
+
+        if (FileExists(getCachePath(asset->hash))) {
+            asset->isCached = true;
+            asset->isFetched = true;
+            continue;
+        }
+        fetchCount++;
+
+        emscripten_fetch_attr_t attr;
+        emscripten_fetch_attr_init(&attr);
+        strcpy(attr.requestMethod, "GET");
+        attr.attributes = EMSCRIPTEN_FETCH_LOAD_TO_MEMORY;
+        attr.onsuccess = fetchFinished;
+        attr.onerror = fetchFinished;
+        attr.userData = asset;
+        fetches[order[i]] = emscripten_fetch(&attr, asset->path);
+    }
+    TraceLog(LOG_INFO, "ASSETS: Fetching %i files that are not cached yet", fetchCount);
+}
+
+static void stopFetches(void) {
+    for (int i = 0; i < assetCount; i++) {
+        if (fetches[i] != NULL) emscripten_fetch_close(fetches[i]);
+        fetches[i] = NULL;
+    }
+    areFetchesStarted = false;
+}
+
+#else
+
+static void startFetches(void) {
+}
+
+static void stopFetches(void) {
+}
+
+#endif
+
+void StartAssetLoading(void) {
+    int count = 0;
+    for (AssetStage stage = ASSET_STAGE_START; stage < ASSET_STAGE_COUNT; stage++) {
+        for (int i = 0; i < assetCount; i++) {
+            if (assets[i].stage == stage) order[count++] = i;
+        }
+        stageEnds[stage] = count;
+    }
+    for (int i = 0; i < assetCount; i++) isDecoded[i] = false;
+
+    nextUpload = 0;
+    isStarted = true;
+    startTime = GetTime();
+    startFetches();
+    startLoaders();
+}
+
+void UpdateAssetLoading(double budget) {
+    if (!isStarted || nextUpload == assetCount) return;
+    startFetches();
+
+    double start = GetTime();
+    while (nextUpload < assetCount) {
+        Asset* asset = &assets[order[nextUpload]];
+        if (!isDecoded[nextUpload]) {
+            if (asset->isRemote ? !asset->isFetched : loaderCount > 0) break;
+            decodeAsset(asset);
+        }
+        uploadAsset(asset);
+        nextUpload++;
+        if (GetTime() - start >= budget) break;
+    }
+
+    if (nextUpload == assetCount) {
+        stopLoaders();
+        TraceLog(LOG_INFO, "ASSETS: Loaded %i assets in %.2f seconds", assetCount, GetTime() - startTime);
+    }
+}
+
+bool IsAssetStageReady(AssetStage stage) {
+    return isStarted && nextUpload >= stageEnds[stage];
+}
+
+float GetAssetProgress(AssetStage stage) {
+    if (!isStarted) return 0.0f;
+    if (stageEnds[stage] == 0) return 1.0f;
+    return nextUpload >= stageEnds[stage] ? 1.0f : (float) nextUpload / stageEnds[stage];
+}
+
+void UnloadAssets(void) {
+    stopLoaders();
+    stopFetches();
+    for (int i = 0; i < assetCount; i++) {
+        Asset* asset = &assets[i];
+        if (asset->isMapped) continue;
+        if (asset->image.data != NULL) UnloadImage(asset->image);
+        if (asset->wave.data != NULL) UnloadWave(asset->wave);
+        if (asset->data != NULL) UnloadFileData(asset->data);
+    }
+    assetCount = 0;
+    nextUpload = 0;
+    isStarted = false;
+    UnloadFileText(manifest);
+    manifest = NULL;
+    remoteCount = 0;
+}
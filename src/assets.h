@@ -0,0 +1,58 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include <stdbool.h>
+#include "raylib.h"
+
+#define MAX_ASSETS 64
+#define MAX_ASSET_LOADERS 4
+#define MAX_ASSET_PATH 128
+#define FETCH_MANIFEST_FILE "fetch.manifest"
+#define ASSET_CACHE_PREFIX "asset-"
+
+// The first game state that uses an asset. Assets load in stage order, so earlier states are ready sooner.
+typedef enum {
+    ASSET_STAGE_START,
+    ASSET_STAGE_CUTSCENE,
+    ASSET_STAGE_GAME,
+    ASSET_STAGE_ENDING,
+    ASSET_STAGE_COUNT
+} AssetStage;
+
+// Reads directory/fetch.manifest, the files the web build left out of its preload, one "<content hash> <path below
+// directory>" per line. Queued assets whose files are listed there and missing locally are read from the saved
+// asset cache, or fetched over HTTP and cached, once the cache has loaded.
+void LoadFetchManifest(const char* directory);
+
+// Whether a file is on disk or can be fetched, for choosing between optional files before queueing them
+bool AssetFileExists(const char* path);
+
+// Queued assets are decoded on loader threads and written to their target once uploaded on the main thread.
+// Until then the target stays zeroed, which raylib draws and plays as nothing. Paths found in an archive opened
+// before queueing are read from the archive instead of decoded.
+void QueueTexture(Texture2D* texture, const char* path, AssetStage stage);
+
+// Sets the filter after upload. A trilinear filter generates the mip chain it needs unless the archive holds one.
+void QueueTextureEx(Texture2D* texture, const char* path, AssetStage stage, TextureFilter filter);
+void QueueSound(Sound* sound, const char* path, AssetStage stage);
+
+// Music starts playing on a loop once its stream is created. Its file data is kept until UnloadAssets,
+// or streamed from the archive, which must then stay open as long as the music.
+void QueueMusic(Music* music, const char* path, AssetStage stage);
+
+// Starts decoding everything queued so far; builds without threads decode inside UpdateAssetLoading instead
+void StartAssetLoading(void);
+
+// Uploads decoded assets in queue order until budget seconds have passed, always uploading at least one
+void UpdateAssetLoading(double budget);
+
+bool IsAssetStageReady(AssetStage stage);
+
+// Fraction of the assets of this and every earlier stage that are uploaded
+float GetAssetProgress(AssetStage stage);
+
+// Stops the loader threads and frees what the loader still holds. Uploaded textures and sounds belong to
+// whoever queued them, and music streams must be unloaded before this frees their data.
+void UnloadAssets(void);
+
+#endif
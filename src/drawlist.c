@@ -0,0 +1,177 @@
+#include "drawlist.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BUCKET_COUNT (DRAW_LAYER_COUNT * MAX_DRAW_TEXTURES)
+
+#define MIN_COMMAND_CAPACITY 256
+
+static Arena* arena = NULL;
+static DrawCommand* commands = NULL;
+static int commandCount = 0;
+static int commandCapacity = 0;
+static int lastCommandCount = 0;
+
+static Texture2D textures[MAX_DRAW_TEXTURES];
+static int textureCount = 1;
+
+static int bucketStart[BUCKET_COUNT + 1];
+static DrawListStats stats;
+
+static DrawCommand* pushCommand(void) {
+    if (commandCount == commandCapacity) {
+        int capacity = commandCapacity * 2;
+        DrawCommand* grown = ARENA_ARRAY(arena, DrawCommand, capacity);
+        memcpy(grown, commands, commandCount * sizeof(DrawCommand));
+        commands = grown;
+        commandCapacity = capacity;
+    }
+    return &commands[commandCount++];
+}
+
+static uint16_t registerTexture(Texture2D texture) {
+    for (int i = 1; i < textureCount; i++) {
+        if (textures[i].id == texture.id) return i;
+    }
+    if (textureCount == MAX_DRAW_TEXTURES) {
+        TraceLog(LOG_FATAL, "DRAWLIST: More than %i textures in one frame", MAX_DRAW_TEXTURES - 1);
+        abort();
+    }
+    textures[textureCount] = texture;
+    return textureCount++;
+}
+
+void BeginDrawList(Arena* frameArena) {
+    // Starting at last frame's size means a steady frame allocates the buffer once and never grows it
+    arena = frameArena;
+    commandCapacity = lastCommandCount > MIN_COMMAND_CAPACITY ? lastCommandCount : MIN_COMMAND_CAPACITY;
+    commands = ARENA_ARRAY(arena, DrawCommand, commandCapacity);
+    commandCount = 0;
+    textureCount = 1;
+}
+
+void PushSprite(DrawLayer layer, SpriteId id, Rectangle source, Rectangle dest, Vector2 origin, float rotation, Color tint) {
+    Texture2D texture = ResolveSprite(id, &source);
+    PushTexture(layer, texture, source, dest, origin, rotation, tint);
+}
+
+void PushTexture(DrawLayer layer, Texture2D texture, Rectangle source, Rectangle dest, Vector2 origin, float rotation, Color tint) {
+    if (tint.a == 0) return;
+    *pushCommand() = (DrawCommand) {
+        .layer = layer,
+        .kind = DRAW_TEXTURE,
+        .texture = registerTexture(texture),
+        .source = source,
+        .dest = dest,
+        .origin = origin,
+        .rotation = rotation,
+        .tint = tint
+    };
+}
+
+void PushRectangle(DrawLayer layer, Rectangle rect, Color color) {
+    if (color.a == 0) return;
+    *pushCommand() = (DrawCommand) { .layer = layer, .kind = DRAW_RECTANGLE, .dest = rect, .tint = color };
+}
+
+void PushCircle(DrawLayer layer, Vector2 center, float radius, Color color) {
+    if (color.a == 0 || radius <= 0.0f) return;
+    *pushCommand() = (DrawCommand) {
+        .layer = layer,
+        .kind = DRAW_CIRCLE,
+        .dest = (Rectangle) { center.x, center.y, radius, radius },
+        .tint = color
+    };
+}
+
+void PushCallback(DrawLayer layer, void (*callback)(void)) {
+    *pushCommand() = (DrawCommand) { .layer = layer, .kind = DRAW_CALLBACK, .callback = callback };
+}
+
+static bool isVisible(const DrawCommand* command, Rectangle viewport) {
+    const Rectangle* dest = &command->dest;
+    Rectangle bounds;
+    if (command->kind == DRAW_CALLBACK) {
+        return true;
+    } else if (command->kind == DRAW_CIRCLE) {
+        bounds = (Rectangle) { dest->x - dest->width, dest->y - dest->width, dest->width * 2, dest->width * 2 };
+    } else if (command->kind == DRAW_RECTANGLE || command->rotation == 0.0f) {
+        bounds = (Rectangle) { dest->x - command->origin.x, dest->y - command->origin.y, fabsf(dest->width), fabsf(dest->height) };
+    } else {
+        // Rotated quads pivot on dest.xy, so bound them by the farthest corner from the pivot
+        float reachX = fmaxf(command->origin.x, fabsf(dest->width) - command->origin.x);
+        float reachY = fmaxf(command->origin.y, fabsf(dest->height) - command->origin.y);
+        float reach = sqrtf(reachX * reachX + reachY * reachY);
+        bounds = (Rectangle) { dest->x - reach, dest->y - reach, reach * 2, reach * 2 };
+    }
+    return bounds.x < viewport.x + viewport.width && bounds.x + bounds.width > viewport.x &&
+           bounds.y < viewport.y + viewport.height && bounds.y + bounds.height > viewport.y;
+}
+
+static bool isOccluder(const DrawCommand* command, Rectangle viewport) {
+    const Rectangle* dest = &command->dest;
+    return command->kind == DRAW_RECTANGLE && command->tint.a == 255 &&
+           dest->x <= viewport.x && dest->y <= viewport.y &&
+           dest->x + dest->width >= viewport.x + viewport.width && dest->y + dest->height >= viewport.y + viewport.height;
+}
+
+void SubmitDrawList(Rectangle viewport) {
+    stats = (DrawListStats) { .pushed = commandCount };
+    lastCommandCount = commandCount;
+    DrawCommand* sorted = ARENA_ARRAY(arena, DrawCommand, commandCount);
+
+    // Stable counting sort on (layer, texture) keeps push order within each group
+    for (int i = 0; i <= BUCKET_COUNT; i++) bucketStart[i] = 0;
+    for (int i = 0; i < commandCount; i++) {
+        bucketStart[commands[i].layer * MAX_DRAW_TEXTURES + commands[i].texture + 1]++;
+    }
+    for (int i = 0; i < BUCKET_COUNT; i++) bucketStart[i + 1] += bucketStart[i];
+    for (int i = 0; i < commandCount; i++) {
+        sorted[bucketStart[commands[i].layer * MAX_DRAW_TEXTURES + commands[i].texture]++] = commands[i];
+    }
+
+    // Nothing under an opaque full-screen rectangle can show through it
+    int first = 0;
+    for (int i = commandCount - 1; i >= 0; i--) {
+        if (isOccluder(&sorted[i], viewport)) {
+            first = i;
+            break;
+        }
+    }
+    stats.culled = first;
+
+    int currentTexture = -1;
+    for (int i = first; i < commandCount; i++) {
+        const DrawCommand* command = &sorted[i];
+        if (!isVisible(command, viewport)) {
+            stats.culled++;
+            continue;
+        }
+        if (command->texture != currentTexture) {
+            currentTexture = command->texture;
+            stats.textureSwitches++;
+        }
+
+        switch (command->kind) {
+            case DRAW_TEXTURE:
+                DrawTexturePro(textures[command->texture], command->source, command->dest, command->origin,
+                               command->rotation, command->tint);
+                break;
+            case DRAW_RECTANGLE:
+                DrawRectangleRec(command->dest, command->tint);
+                break;
+            case DRAW_CIRCLE:
+                DrawCircleV((Vector2) { command->dest.x, command->dest.y }, command->dest.width, command->tint);
+                break;
+            case DRAW_CALLBACK:
+                command->callback();
+                break;
+        }
+    }
+}
+
+DrawListStats GetDrawListStats(void) {
+    return stats;
+}
@@ -0,0 +1,78 @@
+#ifndef DRAWLIST_H
+#define DRAWLIST_H
+
+#include <stdint.h>
+#include "raylib.h"
+#include "sprites.h"
+#include "arena.h"
+
+// Back to front. Commands are submitted by layer, then grouped by texture within a layer,
+// so anything whose relative order matters across textures needs its own layer.
+typedef enum {
+    DRAW_LAYER_CHEESE,
+    DRAW_LAYER_DECALS,
+    DRAW_LAYER_EXPLOSIVE_RATS,
+    DRAW_LAYER_RAT_SPARKS,
+    DRAW_LAYER_RATS,
+    DRAW_LAYER_PLAYER,
+    DRAW_LAYER_PLAYER_SCARS,
+    DRAW_LAYER_HELD_RAT,
+    DRAW_LAYER_FAT_RAT,
+    DRAW_LAYER_WALLS,
+    DRAW_LAYER_POWER_GENERATOR,
+    DRAW_LAYER_POWER_SPARKS,
+    DRAW_LAYER_DARKNESS,
+    DRAW_LAYER_OVERLAY,
+    DRAW_LAYER_EXPLOSION,
+    DRAW_LAYER_PARTICLES,
+    DRAW_LAYER_PARTICLE_SPRITES,
+    DRAW_LAYER_PROMPT,
+    DRAW_LAYER_COUNT
+} DrawLayer;
+
+#define MAX_DRAW_TEXTURES 32
+
+typedef enum {
+    DRAW_TEXTURE,
+    DRAW_RECTANGLE,
+    DRAW_CIRCLE,
+    DRAW_CALLBACK
+} DrawKind;
+
+// Rectangles and circles use dest as their bounds and texture 0, the shapes texture.
+// Callbacks draw whatever they like and are never culled.
+typedef struct {
+    uint8_t layer;
+    uint8_t kind;
+    uint16_t texture;
+    union {
+        Rectangle source;
+        void (*callback)(void);
+    };
+    Rectangle dest;
+    Vector2 origin;
+    float rotation;
+    Color tint;
+} DrawCommand;
+
+typedef struct {
+    int pushed;
+    int culled;
+    int textureSwitches;
+} DrawListStats;
+
+// Empties the list and forgets the textures registered last frame. Commands live in the frame arena,
+// which must not be reset before SubmitDrawList.
+void BeginDrawList(Arena* frameArena);
+
+void PushSprite(DrawLayer layer, SpriteId id, Rectangle source, Rectangle dest, Vector2 origin, float rotation, Color tint);
+void PushTexture(DrawLayer layer, Texture2D texture, Rectangle source, Rectangle dest, Vector2 origin, float rotation, Color tint);
+void PushRectangle(DrawLayer layer, Rectangle rect, Color color);
+void PushCircle(DrawLayer layer, Vector2 center, float radius, Color color);
+void PushCallback(DrawLayer layer, void (*callback)(void));
+
+// Sorts, culls against the viewport and draws everything pushed since BeginDrawList
+void SubmitDrawList(Rectangle viewport);
+DrawListStats GetDrawListStats(void);
+
+#endif
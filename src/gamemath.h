@@ -0,0 +1,46 @@
+#ifndef GAMEMATH_H
+#define GAMEMATH_H
+
+#include <math.h>
+#include "raylib.h"
+
+// Gameplay math helpers, shared with crazy_bench so it measures exactly what the game runs
+
+static inline float max(float a, float b) {
+    return a > b ? a : b;
+}
+
+static inline float min(float a, float b) {
+    return a < b ? a : b;
+}
+
+static inline float clamp(float value, float minValue, float maxValue) {
+    return max(minValue, min(value, maxValue));
+}
+
+static inline float lerp(float a, float b, float t) {
+    return a + (b - a) * t;
+}
+
+static inline Vector2 getDirection(Vector2 a, Vector2 b) {
+    return (Vector2) { b.x - a.x, b.y - a.y };
+}
+
+static inline Vector2 normalize(Vector2 vector) {
+    float length = sqrt(vector.x * vector.x + vector.y * vector.y);
+    return (Vector2) { vector.x / length, vector.y / length };
+}
+
+static inline float distance(Vector2 a, Vector2 b) {
+    return sqrt(pow(b.x - a.x, 2) + pow(b.y - a.y, 2));
+}
+
+static inline float lookAt(Vector2 pointA, Vector2 pointB) {
+    float angle = atan2(pointB.y - pointA.y, pointB.x - pointA.x);
+    if (angle < 0) {
+        angle += 2 * PI;
+    }
+    return angle * 180 / PI;
+}
+
+#endif
@@ -0,0 +1,294 @@
+#include "http.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "raylib.h"
+
+#if defined(__EMSCRIPTEN__)
+#define HTTP_FETCH
+#include <emscripten/fetch.h>
+#elif defined(CRAZY_HTTP_CURL) && !defined(_MSC_VER)
+#define HTTP_CURL
+#include <curl/curl.h>
+#include <pthread.h>
+#endif
+
+#if defined(HTTP_FETCH) || defined(HTTP_CURL)
+
+typedef enum {
+    SLOT_FREE,
+    SLOT_QUEUED,
+    SLOT_RUNNING,
+    SLOT_FINISHED
+} SlotState;
+
+typedef struct {
+    SlotState state;
+    unsigned long sequence;
+    char method[8];
+    char url[HTTP_MAX_URL];
+    char contentType[HTTP_CONTENT_TYPE_SIZE];
+    char body[HTTP_MAX_BODY];
+    size_t bodySize;
+    HttpCallback onFinished;
+    void* userData;
+    int status;
+    char response[HTTP_MAX_RESPONSE + 1];
+    size_t responseSize;
+} HttpSlot;
+
+static HttpSlot slots[HTTP_MAX_REQUESTS];
+static unsigned long nextSequence = 0;
+
+static bool fillSlot(HttpSlot* slot, const HttpRequest* request) {
+    const char* contentType = request->contentType != NULL ? request->contentType : "";
+    if (strlen(request->method) >= sizeof(slot->method) || strlen(request->url) >= sizeof(slot->url)
+        || strlen(contentType) >= sizeof(slot->contentType) || request->bodySize > sizeof(slot->body)) {
+        TraceLog(LOG_WARNING, "HTTP: [%s] Request does not fit", request->url);
+        return false;
+    }
+
+    strcpy(slot->method, request->method);
+    strcpy(slot->url, request->url);
+    strcpy(slot->contentType, contentType);
+    if (request->bodySize > 0) memcpy(slot->body, request->body, request->bodySize);
+    slot->bodySize = request->bodySize;
+    slot->onFinished = request->onFinished;
+    slot->userData = request->userData;
+    slot->status = 0;
+    slot->responseSize = 0;
+    slot->response[0] = '\0';
+    slot->sequence = nextSequence++;
+    return true;
+}
+
+static void deliver(HttpSlot* slot) {
+    HttpResponse response = { slot->status, slot->response, slot->responseSize, slot->userData };
+    if (slot->onFinished != NULL) slot->onFinished(&response);
+}
+
+#endif
+
+#if defined(HTTP_FETCH)
+
+static emscripten_fetch_t* fetches[HTTP_MAX_REQUESTS];
+
+static void fetchFinished(emscripten_fetch_t* fetch) {
+    HttpSlot* slot = fetch->userData;
+    slot->status = fetch->status;
+    slot->responseSize = fetch->numBytes < HTTP_MAX_RESPONSE ? (size_t) fetch->numBytes : HTTP_MAX_RESPONSE;
+    if (slot->responseSize > 0) memcpy(slot->response, fetch->data, slot->responseSize);
+    slot->response[slot->responseSize] = '\0';
+    fetches[slot - slots] = NULL;
+    emscripten_fetch_close(fetch);
+
+    // The slot is freed first, so the callback can send its follow-up right away
+    HttpSlot finished = *slot;
+    slot->state = SLOT_FREE;
+    deliver(&finished);
+}
+
+bool SendHttpRequest(const HttpRequest* request) {
+    HttpSlot* slot = NULL;
+    for (int i = 0; i < HTTP_MAX_REQUESTS && slot == NULL; i++) {
+        if (slots[i].state == SLOT_FREE) slot = &slots[i];
+    }
+    if (slot == NULL || !fillSlot(slot, request)) return false;
+    slot->state = SLOT_RUNNING;
+
+    static const char* noHeaders[] = { NULL };
+    const char** headers = noHeaders;
+    const char* contentTypeHeaders[] = { "Content-Type", slot->contentType, NULL };
+    if (slot->contentType[0] != '\0') headers = contentTypeHeaders;
+
+    // Fetch copies the headers when it starts; the URL and body stay in the slot until it finishes
+    emscripten_fetch_attr_t attr;
+    emscripten_fetch_attr_init(&attr);
+    strcpy(attr.requestMethod, slot->method);
+    attr.attributes = EMSCRIPTEN_FETCH_LOAD_TO_MEMORY;
+    attr.onsuccess = fetchFinished;
+    attr.onerror = fetchFinished;
+    attr.requestHeaders = headers;
+    attr.requestData = slot->bodySize > 0 ? slot->body : NULL;
+    attr.requestDataSize = slot->bodySize;
+    attr.timeoutMSecs = HTTP_TIMEOUT * 1000;
+    attr.userData = slot;
+    fetches[slot - slots] = emscripten_fetch(&attr, slot->url);
+    return true;
+}
+
+void PollHttp(void) {
+}
+
+void ShutdownHttp(void) {
+    for (int i = 0; i < HTTP_MAX_REQUESTS; i++) {
+        if (fetches[i] != NULL) emscripten_fetch_close(fetches[i]);
+        fetches[i] = NULL;
+        slots[i].state = SLOT_FREE;
+    }
+}
+
+#elif defined(HTTP_CURL)
+
+// One worker runs the requests in the order they were sent. Slot states are guarded by the lock; a running
+// slot belongs to the worker and a finished one to the main thread until PollHttp frees it.
+static pthread_t worker;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake = PTHREAD_COND_INITIALIZER;
+static bool isWorkerRunning = false;
+static bool isStopping = false;
+
+static size_t receive(char* data, size_t size, size_t count, void* user) {
+    HttpSlot* slot = user;
+    size_t length = size * count;
+    size_t kept = HTTP_MAX_RESPONSE - slot->responseSize;
+    if (kept > length) kept = length;
+    memcpy(slot->response + slot->responseSize, data, kept);
+    slot->responseSize += kept;
+    return length;
+}
+
+// Lets ShutdownHttp abort a transfer instead of waiting out its timeout
+static int progress(void* user, curl_off_t downloadTotal, curl_off_t downloaded, curl_off_t uploadTotal, curl_off_t uploaded) {
+    (void) user;
+    (void) downloadTotal;
+    (void) downloaded;
+    (void) uploadTotal;
+    (void) uploaded;
+    pthread_mutex_lock(&lock);
+    bool isAborted = isStopping;
+    pthread_mutex_unlock(&lock);
+    return isAborted;
+}
+
+static void perform(CURL* curl, HttpSlot* slot) {
+    char contentType[HTTP_CONTENT_TYPE_SIZE + 16];
+    snprintf(contentType, sizeof(contentType), "Content-Type: %s", slot->contentType);
+    struct curl_slist* headers = NULL;
+    if (slot->contentType[0] != '\0') headers = curl_slist_append(headers, contentType);
+
+    curl_easy_reset(curl);
+    curl_easy_setopt(curl, CURLOPT_URL, slot->url);
+    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, slot->method);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    if (strcmp(slot->method, "GET") != 0) {
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, slot->body);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long) slot->bodySize);
+    }
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, receive);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, slot);
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, progress);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long) HTTP_TIMEOUT);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+
+    long status = 0;
+    if (curl_easy_perform(curl) == CURLE_OK) curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+    slot->status = (int) status;
+    slot->response[slot->responseSize] = '\0';
+    curl_slist_free_all(headers);
+}
+
+static HttpSlot* takeQueuedSlot(void) {
+    HttpSlot* oldest = NULL;
+    for (int i = 0; i < HTTP_MAX_REQUESTS; i++) {
+        if (slots[i].state == SLOT_QUEUED && (oldest == NULL || slots[i].sequence < oldest->sequence)) oldest = &slots[i];
+    }
+    return oldest;
+}
+
+static void* workerMain(void* argument) {
+    (void) argument;
+    CURL* curl = curl_easy_init();
+
+    pthread_mutex_lock(&lock);
+    while (!isStopping) {
+        HttpSlot* slot = takeQueuedSlot();
+        if (slot == NULL) {
+            pthread_cond_wait(&wake, &lock);
+            continue;
+        }
+        slot->state = SLOT_RUNNING;
+        pthread_mutex_unlock(&lock);
+
+        if (curl != NULL) perform(curl, slot);
+
+        pthread_mutex_lock(&lock);
+        slot->state = SLOT_FINISHED;
+    }
+    pthread_mutex_unlock(&lock);
+
+    curl_easy_cleanup(curl);
+    return NULL;
+}
+
+bool SendHttpRequest(const HttpRequest* request) {
+    if (!isWorkerRunning) {
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+        isStopping = false;
+        isWorkerRunning = pthread_create(&worker, NULL, workerMain, NULL) == 0;
+        if (!isWorkerRunning) {
+            TraceLog(LOG_WARNING, "HTTP: Could not start the request thread");
+            curl_global_cleanup();
+            return false;
+        }
+    }
+
+    pthread_mutex_lock(&lock);
+    HttpSlot* slot = NULL;
+    for (int i = 0; i < HTTP_MAX_REQUESTS && slot == NULL; i++) {
+        if (slots[i].state == SLOT_FREE) slot = &slots[i];
+    }
+    bool isQueued = slot != NULL && fillSlot(slot, request);
+    if (isQueued) {
+        slot->state = SLOT_QUEUED;
+        pthread_cond_signal(&wake);
+    }
+    pthread_mutex_unlock(&lock);
+    return isQueued;
+}
+
+void PollHttp(void) {
+    for (int i = 0; i < HTTP_MAX_REQUESTS; i++) {
+        pthread_mutex_lock(&lock);
+        bool isFinished = slots[i].state == SLOT_FINISHED;
+        pthread_mutex_unlock(&lock);
+        if (!isFinished) continue;
+
+        HttpSlot finished = slots[i];
+        pthread_mutex_lock(&lock);
+        slots[i].state = SLOT_FREE;
+        pthread_mutex_unlock(&lock);
+        deliver(&finished);
+    }
+}
+
+void ShutdownHttp(void) {
+    if (!isWorkerRunning) return;
+    pthread_mutex_lock(&lock);
+    isStopping = true;
+    pthread_cond_signal(&wake);
+    pthread_mutex_unlock(&lock);
+    pthread_join(worker, NULL);
+    isWorkerRunning = false;
+
+    for (int i = 0; i < HTTP_MAX_REQUESTS; i++) slots[i].state = SLOT_FREE;
+    curl_global_cleanup();
+}
+
+#else
+
+bool SendHttpRequest(const HttpRequest* request) {
+    static bool isWarned = false;
+    if (!isWarned) TraceLog(LOG_WARNING, "HTTP: Built without a transport, [%s] not sent", request->url);
+    isWarned = true;
+    return false;
+}
+
+void PollHttp(void) {
+}
+
+void ShutdownHttp(void) {
+}
+
+#endif
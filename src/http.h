@@ -0,0 +1,45 @@
+#ifndef HTTP_H
+#define HTTP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define HTTP_MAX_REQUESTS 4
+#define HTTP_MAX_URL 256
+#define HTTP_MAX_BODY 1024
+#define HTTP_MAX_RESPONSE 1024
+#define HTTP_CONTENT_TYPE_SIZE 128
+#define HTTP_TIMEOUT 15
+
+// The body is NUL-terminated and cut off at HTTP_MAX_RESPONSE bytes. Status is 0 when no response arrived.
+typedef struct {
+    int status;
+    const char* body;
+    size_t bodySize;
+    void* userData;
+} HttpResponse;
+
+typedef void (*HttpCallback)(const HttpResponse* response);
+
+typedef struct {
+    const char* method;
+    const char* url;
+    const char* contentType;
+    const char* body;
+    size_t bodySize;
+    HttpCallback onFinished;
+    void* userData;
+} HttpRequest;
+
+// Copies the request and starts it without waiting on the network: through fetch in the browser, on a background
+// thread with libcurl in native builds. Returns false when every request slot is busy, a field does not fit or
+// the build has no transport, in which case the callback never runs.
+bool SendHttpRequest(const HttpRequest* request);
+
+// Runs the callbacks of finished native requests on the calling thread; the browser runs them itself
+void PollHttp(void);
+
+// Abandons requests still in flight without running their callbacks
+void ShutdownHttp(void);
+
+#endif
@@ -0,0 +1,150 @@
+#include "inputlog.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define INPUT_LOG_MAGIC "CRZI"
+#define INPUT_LOG_VERSION 1
+
+// Each record starts with a 16-bit flag word; the mouse position follows only when it changed
+#define LOG_MOUSE_DOWN (1 << 0)
+#define LOG_MOUSE_PRESSED (1 << 1)
+#define LOG_MOUSE_RELEASED (1 << 2)
+#define LOG_THROW_PRESSED (1 << 3)
+#define LOG_MOVING_UP (1 << 4)
+#define LOG_MOVING_DOWN (1 << 5)
+#define LOG_MOVING_LEFT (1 << 6)
+#define LOG_MOVING_RIGHT (1 << 7)
+#define LOG_MOUSE_MOVED (1 << 8)
+#define LOG_LEVEL_START (1 << 15)
+
+static FILE* file = NULL;
+static bool isRecording = false;
+static Vector2 lastMousePosition;
+
+static bool writeBytes(const void* data, size_t size) {
+    return fwrite(data, size, 1, file) == 1;
+}
+
+static bool readBytes(void* data, size_t size) {
+    return fread(data, size, 1, file) == 1;
+}
+
+bool BeginInputRecording(const char* path) {
+    CloseInputLog();
+    file = fopen(path, "wb");
+    if (file == NULL) {
+        TraceLog(LOG_WARNING, "INPUTLOG: Failed to open %s for recording", path);
+        return false;
+    }
+
+    uint16_t version = INPUT_LOG_VERSION;
+    writeBytes(INPUT_LOG_MAGIC, 4);
+    writeBytes(&version, sizeof(version));
+    isRecording = true;
+    lastMousePosition = (Vector2) { 0.0f, 0.0f };
+    return true;
+}
+
+bool BeginInputReplay(const char* path) {
+    CloseInputLog();
+    file = fopen(path, "rb");
+    if (file == NULL) {
+        TraceLog(LOG_WARNING, "INPUTLOG: Failed to open %s for replay", path);
+        return false;
+    }
+
+    char magic[4];
+    uint16_t version;
+    if (!readBytes(magic, 4) || memcmp(magic, INPUT_LOG_MAGIC, 4) != 0 ||
+        !readBytes(&version, sizeof(version)) || version != INPUT_LOG_VERSION) {
+        TraceLog(LOG_WARNING, "INPUTLOG: %s is not a version %i input log", path, INPUT_LOG_VERSION);
+        CloseInputLog();
+        return false;
+    }
+    isRecording = false;
+    lastMousePosition = (Vector2) { 0.0f, 0.0f };
+    return true;
+}
+
+void CloseInputLog(void) {
+    if (file != NULL) fclose(file);
+    file = NULL;
+    isRecording = false;
+}
+
+bool IsRecordingInput(void) {
+    return file != NULL && isRecording;
+}
+
+bool IsReplayingInput(void) {
+    return file != NULL && !isRecording;
+}
+
+void RecordLevelStart(LevelStart levelStart) {
+    if (!IsRecordingInput()) return;
+
+    uint16_t flags = LOG_LEVEL_START;
+    uint8_t level = levelStart.level;
+    uint8_t fullRestart = levelStart.fullRestart;
+    writeBytes(&flags, sizeof(flags));
+    writeBytes(&level, sizeof(level));
+    writeBytes(&fullRestart, sizeof(fullRestart));
+    writeBytes(&levelStart.seed, sizeof(levelStart.seed));
+}
+
+void RecordInputStep(const GameInput* input) {
+    if (!IsRecordingInput()) return;
+
+    uint16_t flags = (input->isMouseDown ? LOG_MOUSE_DOWN : 0) |
+                     (input->isMousePressed ? LOG_MOUSE_PRESSED : 0) |
+                     (input->isMouseReleased ? LOG_MOUSE_RELEASED : 0) |
+                     (input->isThrowPressed ? LOG_THROW_PRESSED : 0) |
+                     (input->isMovingUp ? LOG_MOVING_UP : 0) |
+                     (input->isMovingDown ? LOG_MOVING_DOWN : 0) |
+                     (input->isMovingLeft ? LOG_MOVING_LEFT : 0) |
+                     (input->isMovingRight ? LOG_MOVING_RIGHT : 0);
+
+    // Compared bitwise so that the replayed position is exactly the recorded one
+    bool isMouseMoved = memcmp(&input->mousePosition, &lastMousePosition, sizeof(Vector2)) != 0;
+    if (isMouseMoved) flags |= LOG_MOUSE_MOVED;
+
+    writeBytes(&flags, sizeof(flags));
+    if (isMouseMoved) {
+        writeBytes(&input->mousePosition, sizeof(Vector2));
+        lastMousePosition = input->mousePosition;
+    }
+}
+
+InputLogEvent ReadInputLog(GameInput* input, LevelStart* levelStart) {
+    if (!IsReplayingInput()) return INPUT_LOG_END;
+
+    uint16_t flags;
+    if (!readBytes(&flags, sizeof(flags))) return INPUT_LOG_END;
+
+    if (flags & LOG_LEVEL_START) {
+        uint8_t level, fullRestart;
+        if (!readBytes(&level, sizeof(level)) || !readBytes(&fullRestart, sizeof(fullRestart)) ||
+            !readBytes(&levelStart->seed, sizeof(levelStart->seed))) {
+            return INPUT_LOG_END;
+        }
+        levelStart->level = level;
+        levelStart->fullRestart = fullRestart;
+        return INPUT_LOG_LEVEL_START;
+    }
+
+    if ((flags & LOG_MOUSE_MOVED) && !readBytes(&lastMousePosition, sizeof(Vector2))) return INPUT_LOG_END;
+
+    *input = (GameInput) {
+        .mousePosition = lastMousePosition,
+        .isMouseDown = flags & LOG_MOUSE_DOWN,
+        .isMousePressed = flags & LOG_MOUSE_PRESSED,
+        .isMouseReleased = flags & LOG_MOUSE_RELEASED,
+        .isThrowPressed = flags & LOG_THROW_PRESSED,
+        .isMovingUp = flags & LOG_MOVING_UP,
+        .isMovingDown = flags & LOG_MOVING_DOWN,
+        .isMovingLeft = flags & LOG_MOVING_LEFT,
+        .isMovingRight = flags & LOG_MOVING_RIGHT
+    };
+    return INPUT_LOG_STEP;
+}
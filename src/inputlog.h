@@ -0,0 +1,49 @@
+#ifndef INPUTLOG_H
+#define INPUTLOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "raylib.h"
+
+// Everything a simulation step reads from the player
+typedef struct {
+    Vector2 mousePosition;
+    bool isMouseDown;
+    bool isMousePressed;
+    bool isMouseReleased;
+    bool isThrowPressed;
+    bool isMovingUp;
+    bool isMovingDown;
+    bool isMovingLeft;
+    bool isMovingRight;
+} GameInput;
+
+// A level (re)start: the level entered, whether it was a full restart and the seed the simulation was reseeded with
+typedef struct {
+    int level;
+    bool fullRestart;
+    uint32_t seed;
+} LevelStart;
+
+typedef enum {
+    INPUT_LOG_STEP,
+    INPUT_LOG_LEVEL_START,
+    INPUT_LOG_END
+} InputLogEvent;
+
+// An input log is a binary file of level starts and the input of every fixed step that followed them.
+// Replaying it through the same build reproduces the session bit for bit.
+bool BeginInputRecording(const char* path);
+bool BeginInputReplay(const char* path);
+void CloseInputLog(void);
+
+bool IsRecordingInput(void);
+bool IsReplayingInput(void);
+
+void RecordLevelStart(LevelStart levelStart);
+void RecordInputStep(const GameInput* input);
+
+// Reads the next event, filling input for steps and levelStart for level starts
+InputLogEvent ReadInputLog(GameInput* input, LevelStart* levelStart);
+
+#endif
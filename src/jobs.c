@@ -0,0 +1,218 @@
+#include "jobs.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "raylib.h"
+#include "memory.h"
+
+#if !defined(_MSC_VER) && (!defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__))
+#define JOBS_THREADED
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#endif
+
+static JobFunction currentFunction;
+static void* currentContext;
+static int currentCount;
+static int currentChunkSize;
+static float* partials = NULL;
+static int partialCapacity = 0;
+static bool isReducing = false;
+
+static void runChunk(int chunk) {
+    int begin = chunk * currentChunkSize;
+    int end = begin + currentChunkSize < currentCount ? begin + currentChunkSize : currentCount;
+    float result = currentFunction(currentContext, begin, end);
+    if (isReducing) partials[chunk] = result;
+}
+
+#if defined(JOBS_THREADED)
+
+// Each thread owns a range of chunks, packed as next in the low half and end in the high half so that
+// the owner popping from the front and thieves taking from the back agree through a single CAS
+typedef struct {
+    _Alignas(64) _Atomic uint64_t range;
+} ChunkRange;
+
+static pthread_t workers[MAX_JOB_THREADS];
+static ChunkRange ranges[MAX_JOB_THREADS];
+static int threadCount = 1;
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wakeCondition = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t doneCondition = PTHREAD_COND_INITIALIZER;
+static uint64_t batch = 0;
+static int busyWorkers = 0;
+static bool isShuttingDown = false;
+
+static int popFront(ChunkRange* range) {
+    uint64_t packed = atomic_load(&range->range);
+    for (;;) {
+        uint32_t next = (uint32_t) packed;
+        uint32_t end = (uint32_t) (packed >> 32);
+        if (next >= end) return -1;
+        if (atomic_compare_exchange_weak(&range->range, &packed, packed + 1)) return (int) next;
+    }
+}
+
+static int stealBack(ChunkRange* range) {
+    uint64_t packed = atomic_load(&range->range);
+    for (;;) {
+        uint32_t next = (uint32_t) packed;
+        uint32_t end = (uint32_t) (packed >> 32);
+        if (next >= end) return -1;
+        uint64_t stolen = ((uint64_t) (end - 1) << 32) | next;
+        if (atomic_compare_exchange_weak(&range->range, &packed, stolen)) return (int) end - 1;
+    }
+}
+
+static void runRanges(int self) {
+    for (;;) {
+        int chunk = popFront(&ranges[self]);
+        for (int k = 1; chunk < 0 && k < threadCount; k++) {
+            chunk = stealBack(&ranges[(self + k) % threadCount]);
+        }
+        if (chunk < 0) return;
+        runChunk(chunk);
+    }
+}
+
+static void* workerMain(void* argument) {
+    int self = (int) (intptr_t) argument;
+    uint64_t seenBatch = 0;
+
+    pthread_mutex_lock(&mutex);
+    for (;;) {
+        while (batch == seenBatch && !isShuttingDown) pthread_cond_wait(&wakeCondition, &mutex);
+        if (isShuttingDown) break;
+        seenBatch = batch;
+        pthread_mutex_unlock(&mutex);
+
+        runRanges(self);
+
+        pthread_mutex_lock(&mutex);
+        if (--busyWorkers == 0) pthread_cond_signal(&doneCondition);
+    }
+    pthread_mutex_unlock(&mutex);
+    return NULL;
+}
+
+void InitJobs(int requestedThreads) {
+    if (requestedThreads <= 0) requestedThreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if (requestedThreads > MAX_JOB_THREADS) requestedThreads = MAX_JOB_THREADS;
+
+    threadCount = 1;
+    isShuttingDown = false;
+    for (int i = 1; i < requestedThreads; i++) {
+        if (pthread_create(&workers[i], NULL, workerMain, (void*) (intptr_t) i) != 0) {
+            TraceLog(LOG_WARNING, "JOBS: Could only start %i of %i threads", threadCount, requestedThreads);
+            break;
+        }
+        threadCount++;
+    }
+    TraceLog(LOG_INFO, "JOBS: Running on %i threads", threadCount);
+}
+
+void ShutdownJobs(void) {
+    pthread_mutex_lock(&mutex);
+    isShuttingDown = true;
+    pthread_cond_broadcast(&wakeCondition);
+    pthread_mutex_unlock(&mutex);
+
+    for (int i = 1; i < threadCount; i++) pthread_join(workers[i], NULL);
+    threadCount = 1;
+
+    TrackedFree(partials);
+    partials = NULL;
+    partialCapacity = 0;
+}
+
+static void dispatch(int chunkCount) {
+    if (threadCount == 1 || chunkCount == 1) {
+        for (int chunk = 0; chunk < chunkCount; chunk++) runChunk(chunk);
+        return;
+    }
+
+    // Contiguous ranges keep each thread on neighbouring rats until it runs dry and starts stealing
+    for (int i = 0; i < threadCount; i++) {
+        uint64_t next = (uint64_t) chunkCount * i / threadCount;
+        uint64_t end = (uint64_t) chunkCount * (i + 1) / threadCount;
+        atomic_store(&ranges[i].range, (end << 32) | next);
+    }
+
+    pthread_mutex_lock(&mutex);
+    busyWorkers = threadCount - 1;
+    batch++;
+    pthread_cond_broadcast(&wakeCondition);
+    pthread_mutex_unlock(&mutex);
+
+    runRanges(0);
+
+    // A worker only leaves runRanges once every range is empty and its own chunk is finished
+    pthread_mutex_lock(&mutex);
+    while (busyWorkers > 0) pthread_cond_wait(&doneCondition, &mutex);
+    pthread_mutex_unlock(&mutex);
+}
+
+int GetJobThreadCount(void) {
+    return threadCount;
+}
+
+#else
+
+void InitJobs(int requestedThreads) {
+    (void) requestedThreads;
+}
+
+void ShutdownJobs(void) {
+    TrackedFree(partials);
+    partials = NULL;
+    partialCapacity = 0;
+}
+
+static void dispatch(int chunkCount) {
+    for (int chunk = 0; chunk < chunkCount; chunk++) runChunk(chunk);
+}
+
+int GetJobThreadCount(void) {
+    return 1;
+}
+
+#endif
+
+static int beginJobs(JobFunction function, void* context, int count, int chunkSize) {
+    currentFunction = function;
+    currentContext = context;
+    currentCount = count;
+    currentChunkSize = chunkSize;
+    return (count + chunkSize - 1) / chunkSize;
+}
+
+void RunJobs(JobFunction function, void* context, int count, int chunkSize) {
+    if (count <= 0) return;
+    isReducing = false;
+    dispatch(beginJobs(function, context, count, chunkSize));
+}
+
+float ReduceJobs(JobFunction function, void* context, int count, int chunkSize) {
+    if (count <= 0) return 0.0f;
+    int chunkCount = beginJobs(function, context, count, chunkSize);
+
+    if (chunkCount > partialCapacity) {
+        float* grown = TrackedRealloc(partials, sizeof(float) * chunkCount);
+        if (grown == NULL) {
+            TraceLog(LOG_FATAL, "JOBS: Failed to grow reduction buffer to %i chunks", chunkCount);
+            abort();
+        }
+        partials = grown;
+        partialCapacity = chunkCount;
+    }
+    isReducing = true;
+    dispatch(chunkCount);
+
+    float total = 0.0f;
+    for (int chunk = 0; chunk < chunkCount; chunk++) total += partials[chunk];
+    return total;
+}
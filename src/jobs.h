@@ -0,0 +1,22 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#define MAX_JOB_THREADS 32
+
+// Called for one chunk [begin, end) of a job; the result is only used by ReduceJobs
+typedef float (*JobFunction)(void* context, int begin, int end);
+
+// Starts threadCount - 1 workers next to the calling thread; 0 uses every core. Builds without threads run inline.
+void InitJobs(int threadCount);
+void ShutdownJobs(void);
+int GetJobThreadCount(void);
+
+// Splits [0, count) into chunks of chunkSize and runs them across the pool, the calling thread included,
+// returning once every chunk is done. Idle threads steal chunks from the back of busy threads' ranges.
+// Only the main thread may start jobs, and jobs may not start jobs.
+void RunJobs(JobFunction function, void* context, int count, int chunkSize);
+
+// Like RunJobs, but sums the chunk results in chunk order, so the total does not depend on the thread count
+float ReduceJobs(JobFunction function, void* context, int count, int chunkSize);
+
+#endif
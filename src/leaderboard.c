@@ -0,0 +1,188 @@
+#include "leaderboard.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "raylib.h"
+#include "http.h"
+#include "storage.h"
+
+#define LEADERBOARD_PUBLIC_KEY "b0a306dcf0a7bbc6559dea064d959b469f49ad1b5b7721e1f187b39ae8cd3a67"
+#define LEADERBOARD_BOUNDARY "ANNKwve0ozXAeZrQFMSbveVVr7Mgj5OU1dRnNtlT"
+
+typedef struct {
+    char name[LEADERBOARD_MAX_NAME + 1];
+    int score;
+} PendingScore;
+
+static char baseUrl[LEADERBOARD_MAX_URL] = LEADERBOARD_URL;
+static char userGuid[LEADERBOARD_MAX_GUID] = "";
+static bool isLoaded = false;
+
+static PendingScore queue[LEADERBOARD_QUEUE_SIZE];
+static int queueCount = 0;
+
+// A score in flight is always queue[0]
+static bool isInFlight = false;
+static int failures = 0;
+static double nextAttempt = 0.0;
+
+void InitLeaderboard(const char* url) {
+    snprintf(baseUrl, sizeof(baseUrl), "%s", url);
+}
+
+static void saveQueue(void) {
+    char text[LEADERBOARD_QUEUE_SIZE * (LEADERBOARD_MAX_NAME + 16) + 1] = "";
+    size_t length = 0;
+    for (int i = 0; i < queueCount; i++) {
+        length += (size_t) snprintf(text + length, sizeof(text) - length, "%i %s\n", queue[i].score, queue[i].name);
+    }
+    if (SaveFileText(GetStoragePath(LEADERBOARD_QUEUE_FILE), text)) FlushStorage();
+}
+
+static bool queueScore(const char* name, int score) {
+    for (int i = 0; i < queueCount; i++) {
+        if (strcmp(queue[i].name, name) != 0) continue;
+        if (score <= queue[i].score) return true;
+        // The score in flight was sent as it was, so a better one queues up behind it
+        if (i == 0 && isInFlight) continue;
+        queue[i].score = score;
+        return true;
+    }
+    if (queueCount == LEADERBOARD_QUEUE_SIZE) return false;
+
+    PendingScore* pending = &queue[queueCount++];
+    snprintf(pending->name, sizeof(pending->name), "%s", name);
+    pending->score = score;
+    return true;
+}
+
+bool SubmitLeaderboardScore(const char* name, int score) {
+    if (!queueScore(name, score)) {
+        TraceLog(LOG_WARNING, "LEADERBOARD: Queue is full, dropping the score of %s", name);
+        return false;
+    }
+    if (isLoaded) saveQueue();
+    return true;
+}
+
+static void loadSavedState(void) {
+    const char* guidPath = GetStoragePath(LEADERBOARD_GUID_FILE);
+    if (FileExists(guidPath)) {
+        char* guid = LoadFileText(guidPath);
+        if (guid != NULL) snprintf(userGuid, sizeof(userGuid), "%s", guid);
+        UnloadFileText(guid);
+    }
+
+    int submittedCount = queueCount;
+    const char* queuePath = GetStoragePath(LEADERBOARD_QUEUE_FILE);
+    char* text = FileExists(queuePath) ? LoadFileText(queuePath) : NULL;
+    for (char* line = text != NULL ? strtok(text, "\r\n") : NULL; line != NULL; line = strtok(NULL, "\r\n")) {
+        int score = 0;
+        char name[LEADERBOARD_MAX_NAME + 1];
+        if (sscanf(line, "%i %16[^\n]", &score, name) == 2) queueScore(name, score);
+    }
+    UnloadFileText(text);
+
+    isLoaded = true;
+    saveQueue();
+    if (queueCount > submittedCount) {
+        TraceLog(LOG_INFO, "LEADERBOARD: %i scores from an earlier session are pending", queueCount - submittedCount);
+    }
+}
+
+static void requestFailed(const char* request, int status) {
+    failures++;
+    double delay = LEADERBOARD_RETRY_DELAY * (double) (1 << (failures < 8 ? failures - 1 : 7));
+    if (delay > LEADERBOARD_MAX_RETRY_DELAY) delay = LEADERBOARD_MAX_RETRY_DELAY;
+    nextAttempt = GetTime() + delay;
+    TraceLog(LOG_WARNING, "LEADERBOARD: %s failed (status %i), retrying in %.0f seconds", request, status, delay);
+}
+
+// Network errors report status 0
+static bool isRetryable(int status) {
+    return status == 0 || status == 408 || status == 429 || status >= 500;
+}
+
+static void authorized(const HttpResponse* response) {
+    isInFlight = false;
+    if (response->status == 200 && response->bodySize > 0 && response->bodySize < sizeof(userGuid)) {
+        memcpy(userGuid, response->body, response->bodySize);
+        userGuid[response->bodySize] = '\0';
+        failures = 0;
+        if (SaveFileText(GetStoragePath(LEADERBOARD_GUID_FILE), userGuid)) FlushStorage();
+    } else {
+        requestFailed("Authorization", response->status);
+    }
+}
+
+static void scoreUploaded(const HttpResponse* response) {
+    isInFlight = false;
+    if (response->status == 200) {
+        TraceLog(LOG_INFO, "LEADERBOARD: Uploaded a score of %i for %s", queue[0].score, queue[0].name);
+    } else if (isRetryable(response->status)) {
+        requestFailed("Score upload", response->status);
+        return;
+    } else {
+        TraceLog(LOG_WARNING, "LEADERBOARD: Score of %s rejected (status %i), dropping it", queue[0].name, response->status);
+    }
+    failures = 0;
+    queueCount--;
+    memmove(&queue[0], &queue[1], sizeof(PendingScore) * queueCount);
+    saveQueue();
+}
+
+// A request the transport cannot take counts as a failure, so it is retried like one
+static void sendRequest(const char* request, const HttpRequest* http) {
+    isInFlight = SendHttpRequest(http);
+    if (!isInFlight) requestFailed(request, 0);
+}
+
+static void sendAuthorization(void) {
+    char url[LEADERBOARD_MAX_URL + 32];
+    snprintf(url, sizeof(url), "%s/authorize", baseUrl);
+    sendRequest("Authorization", &(HttpRequest) { .method = "GET", .url = url, .onFinished = authorized });
+}
+
+static void sendScore(const PendingScore* pending) {
+    char url[LEADERBOARD_MAX_URL + 32];
+    char body[LEADERBOARD_BODY_SIZE];
+    snprintf(url, sizeof(url), "%s/entry/upload", baseUrl);
+    int length = snprintf(body, sizeof(body),
+                          "--" LEADERBOARD_BOUNDARY "\nContent-Disposition: form-data; name=\"publicKey\"\n\n" LEADERBOARD_PUBLIC_KEY "\n"
+                          "--" LEADERBOARD_BOUNDARY "\nContent-Disposition: form-data; name=\"username\"\n\n%s\n"
+                          "--" LEADERBOARD_BOUNDARY "\nContent-Disposition: form-data; name=\"score\"\n\n%i\n"
+                          "--" LEADERBOARD_BOUNDARY "\nContent-Disposition: form-data; name=\"userGuid\"\n\n%s\n"
+                          "--" LEADERBOARD_BOUNDARY "--\n",
+                          pending->name, pending->score, userGuid);
+
+    sendRequest("Score upload", &(HttpRequest) {
+        .method = "POST",
+        .url = url,
+        .contentType = "multipart/form-data; boundary=" LEADERBOARD_BOUNDARY,
+        .body = body,
+        .bodySize = (size_t) length,
+        .onFinished = scoreUploaded
+    });
+}
+
+void UpdateLeaderboard(void) {
+    if (!isLoaded) {
+        if (!IsStorageReady()) return;
+        loadSavedState();
+    }
+    if (isInFlight || GetTime() < nextAttempt) return;
+
+    if (userGuid[0] == '\0') sendAuthorization();
+    else if (queueCount > 0) sendScore(&queue[0]);
+}
+
+bool IsLeaderboardScorePending(const char* name, int score) {
+    for (int i = 0; i < queueCount; i++) {
+        if (strcmp(queue[i].name, name) == 0 && queue[i].score >= score) return true;
+    }
+    return false;
+}
+
+int GetPendingScoreCount(void) {
+    return queueCount;
+}
@@ -0,0 +1,33 @@
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include <stdbool.h>
+
+#define LEADERBOARD_URL "https://lcv2-server.danqzq.games"
+#define LEADERBOARD_QUEUE_SIZE 8
+#define LEADERBOARD_MAX_NAME 16
+#define LEADERBOARD_MAX_URL 128
+#define LEADERBOARD_MAX_GUID 64
+#define LEADERBOARD_BODY_SIZE 1024
+#define LEADERBOARD_RETRY_DELAY 2.0
+#define LEADERBOARD_MAX_RETRY_DELAY 120.0
+#define LEADERBOARD_GUID_FILE "user.guid"
+#define LEADERBOARD_QUEUE_FILE "leaderboard.queue"
+
+// Talks to baseUrl, the leaderboard server or a local stand-in for it. Nothing is sent before storage is ready,
+// when the saved GUID and any scores left pending by an earlier session are read back.
+void InitLeaderboard(const char* baseUrl);
+
+// Queues a score, saved until the server accepts it. A name that is already waiting keeps the better of its two
+// scores, so submitting the same highscore again sends nothing new. Returns false when the queue is full.
+bool SubmitLeaderboardScore(const char* name, int score);
+
+// Sends the next request once the previous one has finished and any retry delay has passed. Requests go out one
+// at a time: the GUID first when there is none saved, then queued scores oldest first. Failures from the network
+// or the server retry with a doubling delay; any other rejection drops the score.
+void UpdateLeaderboard(void);
+
+bool IsLeaderboardScorePending(const char* name, int score);
+int GetPendingScoreCount(void);
+
+#endif
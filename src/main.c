@@ -2,14 +2,34 @@
 #include <stdlib.h>
 #include <time.h>
 #include "raylib.h"
+#include "ratstore.h"
+#include "spatialgrid.h"
+#include "steering.h"
+#include "sprites.h"
+#include "drawlist.h"
+#include "overlay.h"
+#include "profiler.h"
+#include "inputlog.h"
+#include "random.h"
+#include "jobs.h"
+#include "arena.h"
+#include "particles.h"
+#include "gamemath.h"
+#include "memory.h"
+#include "assets.h"
+#include "archive.h"
+#include "storage.h"
+#include "leaderboard.h"
+#include "http.h"
 
 #include <stdio.h>
 
 #pragma region Macros
 
 #include <string.h>
+#if defined(PLATFORM_WEB)
 #include <emscripten/emscripten.h>
-#include <emscripten/fetch.h>
+#endif
 
 #define SCREEN_WIDTH 1024
 #define SCREEN_HEIGHT 1024
@@ -18,93 +38,90 @@
 #define BOUNDS_X (Vector2) { WALL_SIZE, SCREEN_WIDTH - WALL_SIZE }
 #define BOUNDS_Y (Vector2) { WALL_SIZE, SCREEN_HEIGHT - WALL_SIZE }
 
+// Frame rate the per-frame easing factors were tuned at; rendering itself follows the display
 #define TARGET_FPS 60
 
+#define SIMULATION_RATE 120
+#define FIXED_TIMESTEP (1.0f / SIMULATION_RATE)
+#define MAX_FRAME_TIME 0.25f
+
 #define SCALE_FACTOR 100
 
 #define BACKGROUND_COLOR CLITERAL(Color){ 130, 90, 100, 255 }
 
-#define MAX_NAME_INPUT_CHARS 16
+#define MAX_NAME_INPUT_CHARS LEADERBOARD_MAX_NAME
 
 #define LEVEL_COUNT 5
 
+#define INITIAL_RAT_CAPACITY 64
+#define GRID_CELL_SIZE 64.0f
+
+// Rats are updated in chunks of this many, a multiple of every steering batch width, on any number of threads
+#define RAT_JOB_CHUNK_SIZE 1024
+
+#define LEVEL_ARENA_SIZE (64 * 1024)
+#define FRAME_ARENA_SIZE (256 * 1024)
+
+#define ASSET_UPLOAD_BUDGET (1.0 / 240.0)
+
+#define HEADLESS_DEFAULT_RUNS 1
+#define HEADLESS_MAX_RUN_TIME 600.0f
+
+#define SOAK_WINDOW_STEPS (SIMULATION_RATE * 60)
+#define SOAK_WARMUP_WINDOWS 10
+#define SOAK_DRIFT_WINDOWS 10
+#define SOAK_MAX_ALLOCATION_GROWTH 8
+#define SOAK_DEFAULT_MAX_RSS_GROWTH 16.0f
+#define SOAK_DEFAULT_MAX_DRIFT 1.5f
+
 #pragma endregion
 
 #pragma region Types
 
 typedef struct {
     Vector2 position;
+    Vector2 previousPosition;
     float rotation;
     Vector2 scale;
 
     Vector2 velocity;
 } Entity;
 
-typedef struct {
-    Entity* entity;
-
-    int type;
-    bool isEnraged;
+// Every kind of rat is an archetype: its own RatStore, moved, spawned and drawn by the same systems,
+// with what differs between kinds described by its ArchetypeDef
+typedef enum {
+    ARCHETYPE_RAT,
+    ARCHETYPE_EXPLOSIVE_RAT,
+    ARCHETYPE_COUNT
+} ArchetypeId;
 
-    float throwTimer;
-    Vector2 throwPosition;
-} Rat;
+typedef struct {
+    SpriteId sprite;
+    DrawLayer layer;
+    int frameCount;
+    float arrivalFactor;
+    float damageMultiplier;
+    float spawnTime;
+    bool isGrabbable;
+    bool squeaksOnSpawn;
+    bool alwaysFacesTarget;
+} ArchetypeDef;
 
 typedef struct {
     int initialSanity;
-    int maxRatCapacity;
-    int maxExplosiveRatCapacity;
+    int maxRats[ARCHETYPE_COUNT];
     bool isFatRatEnabled;
     bool isPowerGeneratorEnabled;
 } LevelData;
 
 #pragma endregion
 
-#pragma region Functions
-
-float max(float a, float b) {
-    return a > b ? a : b;
-}
-
-float min(float a, float b) {
-    return a < b ? a : b;
-}
-
-float clamp(float value, float minValue, float maxValue) {
-    return max(minValue, min(value, maxValue));
-}
-
-float lerp(float a, float b, float t) {
-    return a + (b - a) * t;
-}
-
-Vector2 getDirection(Vector2 a, Vector2 b) {
-    return (Vector2) { b.x - a.x, b.y - a.y };
-}
-
-Vector2 normalize(Vector2 vector) {
-    float length = sqrt(vector.x * vector.x + vector.y * vector.y);
-    return (Vector2) { vector.x / length, vector.y / length };
-}
-
-float distance(Vector2 a, Vector2 b) {
-    return sqrt(pow(b.x - a.x, 2) + pow(b.y - a.y, 2));
-}
-
-float lookAt(Vector2 pointA, Vector2 pointB) {
-    float angle = atan2(pointB.y - pointA.y, pointB.x - pointA.x);
-    if (angle < 0) {
-        angle += 2 * PI;
-    }
-    return angle * 180 / PI;
-}
-
-#pragma endregion
-
 #pragma region Global Variables
 
 const float PLAYER_SPEED = 100.0f;
-const float ENEMY_SPAWN_TIME = 1.0f;
+const float RAT_SPEED = 100.0f;
+const float RAT_THROW_SPEED = 300.0f;
+const float ENRAGED_SPEED_MULTIPLIER = 2.0f;
 const float CHEESE_DECREASE_RATE = 1.0f;
 const float SANITY_DECREASE_RATE = 1.5f;
 const float FLASHLIGHT_DECREASE_RATE = 2.0f;
@@ -117,14 +134,53 @@ const float SURVIVAL_TIME = 80.0f;
 const float HOUR_LENGTH_IN_SECONDS = SURVIVAL_TIME / 9.0f;
 
 const LevelData LEVELS[] = {
-        (LevelData) { 100, 2, 0, false, false },
-        (LevelData) { 100, 2, 0, false, false },
-        (LevelData) { 90, 3, 0, true, false },
-        (LevelData) { 90, 3, 0, true, true },
-        (LevelData) { 80, 4, 1, false, true },
-        (LevelData) { 80, 5, 2, true, true },
+        (LevelData) { 100, { 2, 0 }, false, false },
+        (LevelData) { 100, { 2, 0 }, false, false },
+        (LevelData) { 90, { 3, 0 }, true, false },
+        (LevelData) { 90, { 3, 0 }, true, true },
+        (LevelData) { 80, { 4, 1 }, false, true },
+        (LevelData) { 80, { 5, 2 }, true, true },
 };
 
+// Rat types index the frames of a sprite sheet; damage is per second of contact with the cheese, times the type
+const ArchetypeDef ARCHETYPES[ARCHETYPE_COUNT] = {
+        [ARCHETYPE_RAT] = {
+                .sprite = SPRITE_RATS, .layer = DRAW_LAYER_RATS, .frameCount = 4,
+                .arrivalFactor = SCALE_FACTOR * 1.5f, .damageMultiplier = 1.0f,
+                .spawnTime = 1.0f, .isGrabbable = true, .squeaksOnSpawn = true
+        },
+        [ARCHETYPE_EXPLOSIVE_RAT] = {
+                .sprite = SPRITE_EXPLOSIVE_RAT, .layer = DRAW_LAYER_EXPLOSIVE_RATS, .frameCount = 1,
+                .arrivalFactor = SCALE_FACTOR, .damageMultiplier = 2.0f,
+                .spawnTime = 10.0f, .alwaysFacesTarget = true
+        },
+};
+
+static bool isHeadless = false;
+static float deltaTime = FIXED_TIMESTEP;
+static double gameTime = 0.0;
+static float simulationAccumulator = 0.0f;
+static float renderAlpha = 1.0f;
+static GameInput input;
+
+// Level data is allocated from levelArena and dropped wholesale on every level reset; frameArena holds what
+// a single rendered frame needs. Both keep their memory, so steady gameplay makes no heap calls.
+static Arena levelArena;
+static Arena frameArena;
+
+// Gameplay rolls, spawn positions and cosmetics each get their own stream, reseeded per level from the session stream.
+// Render jitter is drawn per frame rather than per step, so it is kept out of level seeding entirely.
+typedef enum {
+    RANDOM_GAMEPLAY,
+    RANDOM_SPAWN,
+    RANDOM_COSMETIC,
+    RANDOM_RENDER,
+    RANDOM_STREAM_COUNT
+} RandomStreamId;
+
+static RandomStream sessionRandom;
+static RandomStream randomStreams[RANDOM_STREAM_COUNT];
+
 static int currentLevel = 0;
 static float levelTransitionTimer = 0.0f;
 static bool isLevelTransitioning = true;
@@ -138,34 +194,28 @@ static float sanity = 100.0f;
 static float cheese = 100.0f;
 static float health = 100.0f;
 static float flashlight = 100.0f;
-static Rat* currentRatOnPlayer = NULL;
+static RatHandle currentRatOnPlayer = { 0, 0 };
 
-static Rat* enemies;
-static int enemiesCount = 0;
-static float enemySpawnTimer = 0.0f;
-static Rat* currentDraggedRat = NULL;
+static RatStore archetypes[ARCHETYPE_COUNT];
+static float spawnTimers[ARCHETYPE_COUNT];
+static RatStore* const rats = &archetypes[ARCHETYPE_RAT];
+static RatStore* const explosiveRats = &archetypes[ARCHETYPE_EXPLOSIVE_RAT];
+
+// Handles and the grid only ever refer to grabbable rats
+static SpatialGrid ratGrid;
+static RatHandle currentDraggedRat = { 0, 0 };
 
-static Rat* explosiveRats;
-static int explosiveRatCount = 0;
-static float explosiveRatSpawnTimer = 0.0f;
 static float explosionTimer = 0.0f;
-static Vector2 lastExplosionLocation = (Vector2) { 0.0f, 0.0f };
 
 static Entity cheeseEntity;
 static bool isCheeseDragged;
+static bool isCheeseWalking = false;
 
 static Entity powerGenerator;
-static Rat* currentRatOnPowerGenerator = NULL;
+static RatHandle currentRatOnPowerGenerator = { 0, 0 };
 static float powerGeneratorTimer = 0.0f;
 
-static Entity* electricityParticles;
-static Entity* mutateParticles;
-static int mutateParticlesCount = 0;
-static float mutateParticlesTimer = 0.0f;
-static Vector2 lastMutationLocation = (Vector2) { 0.0f, 0.0f };
-static Entity* bloodParticles;
-static int bloodParticlesCount = 0;
-static float bloodParticlesTimer = 0.0f;
+static bool isGeneratorSparking = false;
 static Vector2 lastBloodLocation = (Vector2) { 0.0f, 0.0f };
 static float bloodTextureRotation = 0.0f;
 
@@ -183,12 +233,14 @@ static float redFlashIntensity = 0.0f;
 
 static int score = 0;
 static int highscore = 0;
+// Score the last lost game ended on, since a new highscore resets score as the game ends
+static int runScore = 0;
 static float scoreTimer = 0.0f;
 
 static char username[MAX_NAME_INPUT_CHARS + 1] = "\0";
 static int usernameSize = 0;
 static int inputFieldFrames = 0;
-static bool submittedScore = false;
+static const char* leaderboardUrl = LEADERBOARD_URL;
 
 static float cutsceneTimer = 0.0f;
 
@@ -207,111 +259,88 @@ static Sound squeakSound1, squeakSound2, squeakSound3, splatSound, crazySound, b
 
 #pragma region Textures
 
-static Texture2D spotlightTexture;
 static Texture2D wallsTexture;
-static Texture2D cheeseTexture;
-static Texture2D cheeseWalkTextures[2];
-static Texture2D powerGeneratorTexture;
-
-static Texture2D playerTextureSpritesheet;
-static Texture2D playerScarsTextures[2];
-
-static Texture2D ratTextureSpritesheet;
-static Texture2D explosiveRatTexture;
-static Texture2D fatRatTexture, fatRatHappyTexture;
-static Rectangle fatRatRect;
 
-static Texture2D fatRatTeeth;
 
-static Texture2D redFlashTexture;
+static OverlayParams overlay;
 static Texture2D tutorial[4];
 
 static int currentHandTexture = 0;
-static Texture2D handTextures[3];
-
-static Texture2D electricityParticleTexture;
-static Texture2D poofTexture;
-static Texture2D nomTexture;
-static Texture2D bloodTexture;
-static Texture2D explosionTexture;
 
 static Texture2D cutscenes[2];
 static Texture2D playerFalling;
 static bool isCutscenePlaying;
 
-static Texture2D spaceButtonTexture;
-
 static Texture2D endCutscene;
 
 #pragma endregion
 
-#pragma region Networking
-
-char *USER_GUID = NULL;
-
-void authorized(emscripten_fetch_t *fetch) {
-    USER_GUID = malloc(sizeof(char) * (strlen(fetch->data) + 1));
-    strcpy(USER_GUID, fetch->data);
-    emscripten_fetch_close(fetch);
+void LoadLevelData(void) {
+    LevelData currentLevelData = LEVELS[currentLevel];
+    sanity = currentLevelData.initialSanity;
 }
 
-void scoreSubmitted(emscripten_fetch_t *fetch) {
-    if (fetch->status == 200) {
-        printf("Successfully uploaded score.\n");
+void SnapshotEntities(void) {
+    player.previousPosition = player.position;
+    cheeseEntity.previousPosition = cheeseEntity.position;
+    fatRat.previousPosition = fatRat.position;
+    for (int a = 0; a < ARCHETYPE_COUNT; a++) {
+        memcpy(archetypes[a].previousX, archetypes[a].positionX, sizeof(float) * archetypes[a].count);
+        memcpy(archetypes[a].previousY, archetypes[a].positionY, sizeof(float) * archetypes[a].count);
     }
-    else {
-        printf("Score upload failed, HTTP failure status code: %d.\n", fetch->status);
-    }
-    emscripten_fetch_close(fetch);
-    submittedScore = false;
 }
 
-void requestFailed(emscripten_fetch_t *fetch) {
-    printf("Request failed, HTTP failure status code: %d.\n", fetch->status);
-    emscripten_fetch_close(fetch);
-    submittedScore = false;
+Vector2 GetRenderPosition(const Entity* entity) {
+    return (Vector2) { lerp(entity->previousPosition.x, entity->position.x, renderAlpha),
+                       lerp(entity->previousPosition.y, entity->position.y, renderAlpha) };
 }
 
-unsigned int EMSCRIPTEN_KEEPALIVE InitializeLeaderboardCreator() {
-    emscripten_fetch_attr_t attr;
-    emscripten_fetch_attr_init(&attr);
-    strcpy(attr.requestMethod, "GET");
-    attr.attributes = EMSCRIPTEN_FETCH_LOAD_TO_MEMORY;
-    attr.onsuccess = authorized;
-    attr.onerror = requestFailed;
-    emscripten_fetch(&attr, "https://lcv2-server.danqzq.games/authorize");
-    return 1;
+Vector2 GetRatRenderPosition(const RatStore* store, int index) {
+    return (Vector2) { lerp(store->previousX[index], store->positionX[index], renderAlpha),
+                       lerp(store->previousY[index], store->positionY[index], renderAlpha) };
 }
 
-unsigned int EMSCRIPTEN_KEEPALIVE UploadNewEntry() {
-    emscripten_fetch_attr_t attr;
-    emscripten_fetch_attr_init(&attr);
-    strcpy(attr.requestMethod, "POST");
-    attr.attributes = EMSCRIPTEN_FETCH_LOAD_TO_MEMORY;
-    attr.onsuccess = scoreSubmitted;
-    attr.onerror = requestFailed;
-    const char * headers[] = {"Content-Type", "multipart/form-data; boundary=ANNKwve0ozXAeZrQFMSbveVVr7Mgj5OU1dRnNtlT", 0};
-    attr.requestHeaders = headers;
-
-    const char *params = TextFormat("--ANNKwve0ozXAeZrQFMSbveVVr7Mgj5OU1dRnNtlT\nContent-Disposition: form-data; name=\"publicKey\"\n\nb0a306dcf0a7bbc6559dea064d959b469f49ad1b5b7721e1f187b39ae8cd3a67\n--ANNKwve0ozXAeZrQFMSbveVVr7Mgj5OU1dRnNtlT\nContent-Disposition: form-data; name=\"username\"\n\n%s\n--ANNKwve0ozXAeZrQFMSbveVVr7Mgj5OU1dRnNtlT\nContent-Disposition: form-data; name=\"score\"\n\n%i\n--ANNKwve0ozXAeZrQFMSbveVVr7Mgj5OU1dRnNtlT\nContent-Disposition: form-data; name=\"userGuid\"\n\n%s\n--ANNKwve0ozXAeZrQFMSbveVVr7Mgj5OU1dRnNtlT--\n", username, highscore, USER_GUID);
-    attr.requestData = params;
-    attr.requestDataSize = strlen(attr.requestData);
-    emscripten_fetch(&attr, "https://lcv2-server.danqzq.games/entry/upload");
-    return 1;
+void PollInput(void) {
+    input.mousePosition = GetMousePosition();
+    input.isMouseDown = IsMouseButtonDown(MOUSE_LEFT_BUTTON);
+    input.isMovingUp = IsKeyDown(KEY_W);
+    input.isMovingDown = IsKeyDown(KEY_S);
+    input.isMovingLeft = IsKeyDown(KEY_A);
+    input.isMovingRight = IsKeyDown(KEY_D);
+
+    // Edges are latched until a simulation step consumes them, so a frame that runs no step cannot drop a click
+    input.isMousePressed |= IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
+    input.isMouseReleased |= IsMouseButtonReleased(MOUSE_LEFT_BUTTON);
+    input.isThrowPressed |= IsKeyPressed(KEY_SPACE);
 }
 
-#pragma endregion
+void ConsumeInputEdges(void) {
+    input.isMousePressed = false;
+    input.isMouseReleased = false;
+    input.isThrowPressed = false;
+}
 
-void LoadLevelData(void) {
-    LevelData currentLevelData = LEVELS[currentLevel];
-    sanity = currentLevelData.initialSanity;
-    enemies = malloc(sizeof(Rat) * currentLevelData.maxRatCapacity);
-    explosiveRats = malloc(sizeof(Rat) * currentLevelData.maxExplosiveRatCapacity);
+void SeedSessionRandom(uint64_t seed) {
+    SeedRandom(&sessionRandom, seed, 0);
+    SeedRandom(&randomStreams[RANDOM_RENDER], seed, RANDOM_RENDER + 1);
+    for (int i = 0; i < RANDOM_RENDER; i++) {
+        SeedRandom(&randomStreams[i], seed, i + 1);
+    }
 }
 
-void Start(void) {
-    isCutscenePlaying = true;
+void SeedLevelRandom(uint32_t seed) {
+    for (int i = 0; i < RANDOM_RENDER; i++) {
+        SeedRandom(&randomStreams[i], seed, i + 1);
+    }
+}
+
+void AllocateLevelEffects(void) {
+    ResetArena(&levelArena);
+    InitParticles(&levelArena, &randomStreams[RANDOM_COSMETIC]);
+    isGeneratorSparking = false;
+}
 
+void InitEntities(void) {
     player = (Entity) {
         .position = (Vector2) { 400.0f, 400.0f },
         .rotation = 0.0f,
@@ -342,95 +371,81 @@ void Start(void) {
 
     isCheeseDragged = false;
 
-    cutscenes[0] = LoadTexture("resources/cutscene0.png");
-    cutscenes[1] = LoadTexture("resources/cutscene1.png");
-    playerFalling = LoadTexture("resources/falling.png");
-    endCutscene = LoadTexture("resources/end.png");
-
-    playerScarsTextures[0] = LoadTexture("resources/scars1.png");
-    playerScarsTextures[1] = LoadTexture("resources/scars2.png");
-
-    handTextures[0] = LoadTexture("resources/hand.png");
-    handTextures[1] = LoadTexture("resources/hand_rat.png");
-    handTextures[2] = LoadTexture("resources/hand_cheese.png");
-
-    spotlightTexture = LoadTexture("resources/spotlight.png");
-    wallsTexture = LoadTexture("resources/walls.png");
-    cheeseTexture = LoadTexture("resources/cheese_normal.png");
-    cheeseWalkTextures[0] = LoadTexture("resources/cheese_walk1.png");
-    cheeseWalkTextures[1] = LoadTexture("resources/cheese_walk2.png");
-
-    playerTextureSpritesheet = LoadTexture("resources/player_spritesheet.png");
-
-    ratTextureSpritesheet = LoadTexture("resources/rats.png");
-    explosiveRatTexture = LoadTexture("resources/explosive_rat.png");
-    fatRatTexture = LoadTexture("resources/fatrat.png");
-    fatRatHappyTexture = LoadTexture("resources/fatrat_happy.png");
-    fatRatRect = (Rectangle) { 0, 0, fatRatTexture.width, fatRatTexture.height };
-    fatRatTeeth = LoadTexture("resources/teeth.png");
-
-    redFlashTexture = LoadTexture("resources/red_flash.png");
-
-    powerGeneratorTexture = LoadTexture("resources/power_generator.png");
-    electricityParticleTexture = LoadTexture("resources/elec.png");
-
-    poofTexture = LoadTexture("resources/poof.png");
-    nomTexture = LoadTexture("resources/nom.png");
-    bloodTexture = LoadTexture("resources/blood.png");
-    explosionTexture = LoadTexture("resources/boom.png");
+    for (int a = 0; a < ARCHETYPE_COUNT; a++) {
+        InitRatStore(&archetypes[a], INITIAL_RAT_CAPACITY);
+    }
+    InitSpatialGrid(&ratGrid, SCREEN_WIDTH, SCREEN_HEIGHT, GRID_CELL_SIZE);
 
-    spaceButtonTexture = LoadTexture("resources/space_button.png");
+    InitArena(&levelArena, LEVEL_ARENA_SIZE);
+    AllocateLevelEffects();
 
-    tutorial[0] = LoadTexture("resources/tutorial1.png");
-    tutorial[1] = LoadTexture("resources/tutorial2.png");
-    tutorial[2] = LoadTexture("resources/tutorial3.png");
-    tutorial[3] = LoadTexture("resources/tutorial4.png");
+    LoadLevelData();
+    SnapshotEntities();
+}
 
+// Everything is queued by the first state that uses it and loads in the background while the start screen is up
+void LoadAssets(void) {
     InitAudioDevice();
+    OpenArchive("resources");
+    LoadFetchManifest("resources");
+
+    QueueSound(&crazySound, "resources/crazy.wav", ASSET_STAGE_START);
+    QueueMusic(&cutsceneMusic, "resources/music.mp3", ASSET_STAGE_START);
+
+    QueueTexture(&cutscenes[0], "resources/cutscene0.png", ASSET_STAGE_CUTSCENE);
+    QueueTexture(&cutscenes[1], "resources/cutscene1.png", ASSET_STAGE_CUTSCENE);
+    QueueBakedTexture(&playerFalling, "resources", "falling.png", ASSET_STAGE_CUTSCENE);
+    QueueSound(&clockSound, "resources/clock.wav", ASSET_STAGE_CUTSCENE);
+
+    QueueSprites("resources", ASSET_STAGE_GAME);
+    QueueTexture(&wallsTexture, "resources/walls.png", ASSET_STAGE_GAME);
+    LoadOverlay("resources", SCREEN_WIDTH, SCREEN_HEIGHT, ASSET_STAGE_GAME);
+
+    QueueTexture(&tutorial[0], "resources/tutorial1.png", ASSET_STAGE_GAME);
+    QueueTexture(&tutorial[1], "resources/tutorial2.png", ASSET_STAGE_GAME);
+    QueueTexture(&tutorial[2], "resources/tutorial3.png", ASSET_STAGE_GAME);
+    QueueTexture(&tutorial[3], "resources/tutorial4.png", ASSET_STAGE_GAME);
+
+    QueueSound(&biteSound, "resources/bite.wav", ASSET_STAGE_GAME);
+    QueueSound(&elecSound, "resources/elec.wav", ASSET_STAGE_GAME);
+    QueueSound(&explosionSound, "resources/explosion.wav", ASSET_STAGE_GAME);
+    QueueSound(&nomSound, "resources/nom.wav", ASSET_STAGE_GAME);
+    QueueSound(&poofSound, "resources/poof.wav", ASSET_STAGE_GAME);
+    QueueSound(&popSound1, "resources/pop1.wav", ASSET_STAGE_GAME);
+    QueueSound(&popSound2, "resources/pop2.wav", ASSET_STAGE_GAME);
+    QueueSound(&screamingSound, "resources/screaming.wav", ASSET_STAGE_GAME);
+    QueueSound(&sniffSound, "resources/sniff.wav", ASSET_STAGE_GAME);
+    QueueSound(&squeakSound1, "resources/squeak1.wav", ASSET_STAGE_GAME);
+    QueueSound(&squeakSound2, "resources/squeak2.wav", ASSET_STAGE_GAME);
+    QueueSound(&squeakSound3, "resources/squeak3.wav", ASSET_STAGE_GAME);
+    QueueSound(&splatSound, "resources/splat.wav", ASSET_STAGE_GAME);
+    QueueMusic(&ambienceMusic, "resources/ambience.wav", ASSET_STAGE_GAME);
+
+    QueueTexture(&endCutscene, "resources/end.png", ASSET_STAGE_ENDING);
+
+    StartAssetLoading();
+}
 
-    clockSound = LoadSound("resources/clock.wav");
-    biteSound = LoadSound("resources/bite.wav");
-    elecSound = LoadSound("resources/elec.wav");
-    explosionSound = LoadSound("resources/explosion.wav");
-    nomSound = LoadSound("resources/nom.wav");
-    poofSound = LoadSound("resources/poof.wav");
-    popSound1 = LoadSound("resources/pop1.wav");
-    popSound2 = LoadSound("resources/pop2.wav");
-    screamingSound = LoadSound("resources/screaming.wav");
-    sniffSound = LoadSound("resources/sniff.wav");
-    squeakSound1 = LoadSound("resources/squeak1.wav");
-    squeakSound2 = LoadSound("resources/squeak2.wav");
-    squeakSound3 = LoadSound("resources/squeak3.wav");
-    splatSound = LoadSound("resources/splat.wav");
-    crazySound = LoadSound("resources/crazy.wav");
-
-    ambienceMusic = LoadMusicStream("resources/ambience.wav");
-    cutsceneMusic = LoadMusicStream("resources/music.mp3");
-    ambienceMusic.looping = true;
-    cutsceneMusic.looping = true;
-    PlayMusicStream(ambienceMusic);
-    PlayMusicStream(cutsceneMusic);
-
-    electricityParticles = malloc(sizeof(Entity) * 10);
-    for (int i = 0; i < 10; i++) {
-        electricityParticles[i] = (Entity) {
-            .position = powerGenerator.position,
-            .rotation = 0.0f,
-            .scale = (Vector2) { 0.25f, 0.25f },
-            .velocity = (Vector2) { 0.0f, 0.0f }
-        };
-        electricityParticles[i].position.x += rand() % 100 - 50;
-    }
+void Start(void) {
+    isCutscenePlaying = true;
 
-    InitializeLeaderboardCreator();
-    HideCursor();
+    InitEntities();
+    InitArena(&frameArena, FRAME_ARENA_SIZE);
+    MountStorage();
+    InitLeaderboard(leaderboardUrl);
+    LoadAssets();
 
-    LoadLevelData();
+    HideCursor();
 }
 
-void ResetLevel(bool fullRestart) {
+// Every level starts from a fresh seed so that it replays identically whatever ran between levels
+void ResetLevelWithSeed(bool fullRestart, uint32_t seed) {
+    SeedLevelRandom(seed);
     currentTime = 0.0f;
-    enemiesCount = 0;
+    for (int a = 0; a < ARCHETYPE_COUNT; a++) {
+        ClearRatStore(&archetypes[a]);
+        spawnTimers[a] = 0.0f;
+    }
     if (fullRestart) {
         currentLevel = 0;
         health = 100.0f;
@@ -448,18 +463,29 @@ void ResetLevel(bool fullRestart) {
     fatRatTeethPosition = 0.0f;
 
     screenFlickerTimer = SCREEN_FLICKER_TIME;
-    enemies = realloc(enemies, 0);
-    currentDraggedRat = NULL;
-    currentRatOnPowerGenerator = NULL;
-    currentRatOnPlayer = NULL;
+    currentDraggedRat = RAT_HANDLE_NONE;
+    currentRatOnPowerGenerator = RAT_HANDLE_NONE;
+    currentRatOnPlayer = RAT_HANDLE_NONE;
 
     isCheeseDragged = false;
     isCheeseInsane = false;
 
+    // The game over screen keeps animating these with the frame time, so they must not carry over
+    explosionTimer = -1.0f;
+    AllocateLevelEffects();
+
     player.position = (Vector2) { 400.0f, 400.0f };
     cheeseEntity.position = (Vector2) { SCREEN_WIDTH * 0.5f, SCREEN_HEIGHT * 0.5f };
+    SnapshotEntities();
+    simulationAccumulator = 0.0f;
 
-    HideCursor();
+    RecordLevelStart((LevelStart) { currentLevel, fullRestart, seed });
+
+    if (!isHeadless) HideCursor();
+}
+
+void ResetLevel(bool fullRestart) {
+    ResetLevelWithSeed(fullRestart, NextRandom(&sessionRandom));
 }
 
 void UpdateCutscenes(void) {
@@ -512,21 +538,22 @@ void UpdateCutscenes(void) {
 
 void UpdateStats(void) {
     if (cheese <= 0.0f || sanity <= 0.0f || health <= 0.0f) {
+        if (!isGameOver) runScore = score;
         isGameOver = true;
-        ShowCursor();
+        if (!isHeadless) ShowCursor();
         if (score > highscore) {
             highscore = score;
             score = 0;
         }
     }
 
-    scoreTimer += GetFrameTime();
+    scoreTimer += deltaTime;
     if (scoreTimer >= 1.0f) {
         scoreTimer = 0.0f;
         score++;
     }
 
-    currentTime += GetFrameTime();
+    currentTime += deltaTime;
 
     if (currentTime >= SURVIVAL_TIME) {
         isLevelTransitioning = true;
@@ -536,10 +563,10 @@ void UpdateStats(void) {
     if (!LEVELS[currentLevel].isPowerGeneratorEnabled)
         return;
 
-    if (currentRatOnPowerGenerator == NULL && flashlight > 0.0f) {
-        flashlight -= FLASHLIGHT_DECREASE_RATE * GetFrameTime();
+    if (!IsRatAlive(rats, currentRatOnPowerGenerator) && flashlight > 0.0f) {
+        flashlight -= FLASHLIGHT_DECREASE_RATE * deltaTime;
     } else if (flashlight < 100.0f) {
-        flashlight += FLASHLIGHT_CHARGE_RATE * GetFrameTime();
+        flashlight += FLASHLIGHT_CHARGE_RATE * deltaTime;
     }
 }
 
@@ -548,76 +575,77 @@ void OnDamageTaken(void) {
 }
 
 void UpdateCheese(void) {
+    isCheeseWalking = false;
     if (isCheeseDragged) return;
 
-    float w = cheeseTexture.width * 0.125f;
-    float h = cheeseTexture.height * 0.125f;
     if (sanity <= 50.0f) {
         if (!isCheeseInsane) {
             isCheeseInsane = true;
             PlaySound(screamingSound);
         }
-        Rat* closestRat = NULL;
-        float closestDistance = 1000.0f;
-        for (int i = 0; i < enemiesCount; ++i) {
-            Rat* rat = &enemies[i];
-
-            if (distance(rat->entity->position, cheeseEntity.position) < closestDistance) {
-                closestDistance = distance(rat->entity->position, cheeseEntity.position);
-                closestRat = rat;
-            }
-        }
-
-        if (closestRat != NULL) {
-            Vector2 direction = normalize(getDirection(cheeseEntity.position, closestRat->entity->position));
+        int closestRat = FindNearestRat(&ratGrid, rats, cheeseEntity.position, 1000.0f);
+        if (closestRat >= 0) {
+            Vector2 direction = normalize(getDirection(cheeseEntity.position, GetRatPosition(rats, closestRat)));
             cheeseEntity.velocity.x = -direction.x * 50;
             cheeseEntity.velocity.y = -direction.y * 50;
 
-            cheeseEntity.position.x += cheeseEntity.velocity.x * GetFrameTime();
-            cheeseEntity.position.y += cheeseEntity.velocity.y * GetFrameTime();
+            cheeseEntity.position.x += cheeseEntity.velocity.x * deltaTime;
+            cheeseEntity.position.y += cheeseEntity.velocity.y * deltaTime;
 
             cheeseEntity.position.x = clamp(cheeseEntity.position.x, BOUNDS_X.x, BOUNDS_X.y);
             cheeseEntity.position.y = clamp(cheeseEntity.position.y, BOUNDS_Y.x, BOUNDS_Y.y);
 
-            int index = (int) (GetTime() * 5) % 2;
+            isCheeseWalking = true;
+        }
+    }
+}
+
+void DrawCheese(void) {
+    Vector2 size = GetSpriteSize(SPRITE_CHEESE);
+    float w = size.x * 0.125f;
+    float h = size.y * 0.125f;
+    Vector2 position = GetRenderPosition(&cheeseEntity);
 
-            DrawTexturePro(cheeseWalkTextures[index], (Rectangle) { 0, 0, cheeseWalkTextures[index].width *
-                                                                          (fabsf(cheeseEntity.velocity.x - 1.0f) < 1.0f || cheeseEntity.velocity.x > 0 ? 1 : -1), cheeseWalkTextures[index].height },
-                           (Rectangle) { cheeseEntity.position.x, cheeseEntity.position.y, w, h },
-                           (Vector2) { w * 0.5f, h * 0.5f }, 0, WHITE);
+    if (isCheeseWalking) {
+        SpriteId frame = SPRITE_CHEESE_WALK1 + (int) (gameTime * 5) % 2;
+        Vector2 frameSize = GetSpriteSize(frame);
 
-            return;
-        }
+        PushSprite(DRAW_LAYER_CHEESE, frame, (Rectangle) { 0, 0, frameSize.x *
+                                                                 (fabsf(cheeseEntity.velocity.x - 1.0f) < 1.0f || cheeseEntity.velocity.x > 0 ? 1 : -1), frameSize.y },
+                       (Rectangle) { position.x, position.y, w, h },
+                       (Vector2) { w * 0.5f, h * 0.5f }, 0, WHITE);
+        return;
     }
 
-    DrawTexturePro(cheeseTexture, (Rectangle) {0, 0, cheeseTexture.width, cheeseTexture.height},
-                   (Rectangle) {cheeseEntity.position.x, cheeseEntity.position.y, w, h},
-                   (Vector2) {w * 0.5f, h * 0.5f}, 0, WHITE);
+    if (isCheeseDragged) return;
+
+    PushSprite(DRAW_LAYER_CHEESE, SPRITE_CHEESE, (Rectangle) {0, 0, size.x, size.y},
+               (Rectangle) {position.x, position.y, w, h},
+               (Vector2) {w * 0.5f, h * 0.5f}, 0, WHITE);
 }
 
 void UpdatePlayer(void) {
-    Vector2 mousePosition = GetMousePosition();
-    float angle = lookAt(player.position, mousePosition);
+    float angle = lookAt(player.position, input.mousePosition);
     player.rotation = angle + 90;
 
-    if (IsKeyDown(KEY_W)) {
+    if (input.isMovingUp) {
         player.velocity.y = -PLAYER_SPEED;
-    } else if (IsKeyDown(KEY_S)) {
+    } else if (input.isMovingDown) {
         player.velocity.y = PLAYER_SPEED;
     } else {
         player.velocity.y = 0;
     }
 
-    if (IsKeyDown(KEY_A)) {
+    if (input.isMovingLeft) {
         player.velocity.x = -PLAYER_SPEED;
-    } else if (IsKeyDown(KEY_D)) {
+    } else if (input.isMovingRight) {
         player.velocity.x = PLAYER_SPEED;
     } else {
         player.velocity.x = 0;
     }
 
-    player.position.x += player.velocity.x * GetFrameTime();
-    player.position.y += player.velocity.y * GetFrameTime();
+    player.position.x += player.velocity.x * deltaTime;
+    player.position.y += player.velocity.y * deltaTime;
 
     if (player.position.x < BOUNDS_X.x) {
         player.position.x = BOUNDS_X.x;
@@ -631,8 +659,29 @@ void UpdatePlayer(void) {
         player.position.y = BOUNDS_Y.y;
     }
 
-    float w = playerTextureSpritesheet.width / 4.0f;
-    float h = playerTextureSpritesheet.height;
+    int ratOnPlayer = GetRatIndex(rats, currentRatOnPlayer);
+    if (ratOnPlayer >= 0) {
+        float damage = clamp(2 * rats->type[ratOnPlayer], 0, 8);
+        health -= damage * deltaTime;
+        OnDamageTaken();
+
+        if (input.isThrowPressed) {
+            Vector2 position = (Vector2) { 0, 0 };
+            position.x = player.position.x + cosf((player.rotation - 90) * PI / 180) * 300;
+            position.y = player.position.y + sinf((player.rotation - 90) * PI / 180) * 300;
+            rats->throwX[ratOnPlayer] = position.x;
+            rats->throwY[ratOnPlayer] = position.y;
+            rats->throwTimer[ratOnPlayer] = 0.5f;
+            currentRatOnPlayer = RAT_HANDLE_NONE;
+        }
+    }
+}
+
+void DrawPlayer(void) {
+    Vector2 position = GetRenderPosition(&player);
+    Vector2 size = GetSpriteSize(SPRITE_PLAYER);
+    float w = size.x / 4.0f;
+    float h = size.y;
     Rectangle sourceRec = (Rectangle) { 0, 0, w, h };
     if (sanity <= 25.0f) {
         sourceRec.x = 256 * 3;
@@ -642,55 +691,41 @@ void UpdatePlayer(void) {
         sourceRec.x = 256 * 1;
     }
 
-    DrawTexturePro(playerTextureSpritesheet, sourceRec,
-                   (Rectangle) { player.position.x, player.position.y, w * 0.5f, h * 0.5f },
-                   (Vector2) { w * 0.25f, h * 0.25f }, player.rotation - 90, WHITE);
+    PushSprite(DRAW_LAYER_PLAYER, SPRITE_PLAYER, sourceRec,
+               (Rectangle) { position.x, position.y, w * 0.5f, h * 0.5f },
+               (Vector2) { w * 0.25f, h * 0.25f }, player.rotation - 90, WHITE);
 
-    if (health <= 25.0f) {
-        DrawTexturePro(playerScarsTextures[1],
-                       (Rectangle) {0, 0, playerScarsTextures[1].width, playerScarsTextures[1].height},
-                       (Rectangle) {player.position.x, player.position.y, w * 0.5f, h * 0.5f},
-                       (Vector2) {w * 0.25f, h * 0.25f}, player.rotation - 90, WHITE);
-    } else if (health <= 50.0f) {
-        DrawTexturePro(playerScarsTextures[0],
-                       (Rectangle) {0, 0, playerScarsTextures[0].width, playerScarsTextures[0].height},
-                       (Rectangle) {player.position.x, player.position.y, w * 0.5f, h * 0.5f},
-                       (Vector2) {w * 0.25f, h * 0.25f}, player.rotation - 90, WHITE);
+    if (health <= 50.0f) {
+        SpriteId scars = health <= 25.0f ? SPRITE_SCARS2 : SPRITE_SCARS1;
+        Vector2 scarsSize = GetSpriteSize(scars);
+        PushSprite(DRAW_LAYER_PLAYER_SCARS, scars,
+                   (Rectangle) {0, 0, scarsSize.x, scarsSize.y},
+                   (Rectangle) {position.x, position.y, w * 0.5f, h * 0.5f},
+                   (Vector2) {w * 0.25f, h * 0.25f}, player.rotation - 90, WHITE);
     }
 
-    if (currentRatOnPlayer != NULL) {
-        Entity* entity = currentRatOnPlayer->entity;
-        w = entity->scale.x * SCALE_FACTOR + 25;
-        h = entity->scale.y * SCALE_FACTOR + 25;
-        sourceRec = (Rectangle) { clamp(currentRatOnPlayer->type - 1, 0, 4) * 256, 0, ratTextureSpritesheet.width / 4.0f, ratTextureSpritesheet.height };
+    int ratOnPlayer = GetRatIndex(rats, currentRatOnPlayer);
+    if (ratOnPlayer >= 0) {
+        w = rats->scale[ratOnPlayer] * SCALE_FACTOR + 25;
+        h = rats->scale[ratOnPlayer] * SCALE_FACTOR + 25;
+        Vector2 ratsSize = GetSpriteSize(SPRITE_RATS);
+        sourceRec = (Rectangle) { clamp(rats->type[ratOnPlayer] - 1, 0, 4) * 256, 0, ratsSize.x / 4.0f, ratsSize.y };
 
-        DrawTexturePro(ratTextureSpritesheet, sourceRec,
-                       (Rectangle) { player.position.x, player.position.y, w, h },
-                       (Vector2) { w * 0.5f, h * 0.5f }, player.rotation - 90 + sinf(GetTime() * 20) * 50, WHITE);
-
-        float damage = clamp(2 * currentRatOnPlayer->type, 0, 8);
-        health -= damage * GetFrameTime();
-        OnDamageTaken();
-
-        if (IsKeyPressed(KEY_SPACE)) {
-            Vector2 position = (Vector2) { 0, 0 };
-            position.x = player.position.x + cosf((player.rotation - 90) * PI / 180) * 300;
-            position.y = player.position.y + sinf((player.rotation - 90) * PI / 180) * 300;
-            currentRatOnPlayer->throwPosition = position;
-            currentRatOnPlayer->throwTimer = 0.5f;
-            currentRatOnPlayer = NULL;
-        }
+        PushSprite(DRAW_LAYER_HELD_RAT, SPRITE_RATS, sourceRec,
+                   (Rectangle) { position.x, position.y, w, h },
+                   (Vector2) { w * 0.5f, h * 0.5f }, player.rotation - 90 + sinf(gameTime * 20) * 50, WHITE);
     }
 }
 
 void UpdateFatRat(void) {
-    fatRatTimer += GetFrameTime();
+    fatRatTimer += deltaTime;
     if (fatRatTimer < FAT_RAT_SPAWN_TIME) return;
-    Vector2 playerToMouse = normalize(getDirection(player.position, GetMousePosition()));
+    Vector2 playerToMouse = normalize(getDirection(player.position, input.mousePosition));
     if (!isFatRatSpawned) {
         isFatRatSpawned = true;
         fatRat.position.x = player.position.x - playerToMouse.x * 500;
         fatRat.position.y = player.position.y - playerToMouse.y * 500;
+        fatRat.previousPosition = fatRat.position;
         PlaySound(sniffSound);
         return;
     }
@@ -705,321 +740,271 @@ void UpdateFatRat(void) {
     }
 
     float w = fatRat.scale.x * SCALE_FACTOR;
-    float h = fatRat.scale.y * SCALE_FACTOR;
 
     float distanceToPlayer = distance(fatRat.position, player.position);
     if (distanceToPlayer < w * 0.5f) {
-        health -= 10 * GetFrameTime();
+        health -= 10 * deltaTime;
         fatRat.velocity.x = 0;
         fatRat.velocity.y = 0;
 
-        redFlashIntensity = cosf(GetTime() * 10) * 0.5f + 0.5f;
+        redFlashIntensity = cosf(gameTime * 10) * 0.5f + 0.5f;
 
-        if (lastBiteTime + 0.5f < GetTime()) {
-            lastBiteTime = GetTime();
+        if (lastBiteTime + 0.5f < gameTime) {
+            lastBiteTime = gameTime;
             PlaySound(biteSound);
         }
 
-        fatRatTeethPosition = cosf(GetTime() * 10) * FAT_RAT_TEETH_MAX_POSITION;
+        fatRatTeethPosition = cosf(gameTime * 10) * FAT_RAT_TEETH_MAX_POSITION;
         fatRatTeethPosition = clamp(fatRatTeethPosition, 0, FAT_RAT_TEETH_MAX_POSITION);
     } else if (distanceToPlayer > SCREEN_WIDTH) {
         isFatRatSpawned = false;
         fatRatTimer = 0.0f;
         numberOfRatsFed = 0;
     } else {
-        fatRatTeethPosition = lerp(fatRatTeethPosition, 0, 0.1f);
+        fatRatTeethPosition = lerp(fatRatTeethPosition, 0, 1.0f - powf(0.9f, deltaTime * TARGET_FPS));
     }
 
     fatRat.rotation = lookAt(fatRat.position, player.position) + 90;
-    fatRat.position.x += fatRat.velocity.x * GetFrameTime();
-    fatRat.position.y += fatRat.velocity.y * GetFrameTime();
-
-    DrawTexturePro(numberOfRatsFed >= 3 ? fatRatHappyTexture : fatRatTexture, fatRatRect,
-                   (Rectangle) { fatRat.position.x, fatRat.position.y, w, h },
-                   (Vector2) { w * 0.5f, h * 0.5f }, fatRat.rotation - 90, WHITE);
+    fatRat.position.x += fatRat.velocity.x * deltaTime;
+    fatRat.position.y += fatRat.velocity.y * deltaTime;
 }
 
-void UpdateRatSpawner() {
-    if (enemiesCount >= LEVELS[currentLevel].maxRatCapacity) return;
-    enemySpawnTimer += GetFrameTime();
-
-    if (enemySpawnTimer < ENEMY_SPAWN_TIME) return;
-    enemySpawnTimer = 0.0f;
-    enemiesCount++;
-
-    Vector2 randomPos;
-    if (rand() % 2 == 0) {
-        randomPos.x = rand() % (int) BOUNDS_X.y;
-        randomPos.y = rand() % 2 == 0 ? BOUNDS_Y.x : BOUNDS_Y.y;
-        PlaySound(squeakSound3);
-    }
-    else {
-        randomPos.x = rand() % 2 == 0 ? BOUNDS_X.x : BOUNDS_X.y;
-        randomPos.y = rand() % (int) BOUNDS_Y.y;
-        PlaySound(squeakSound2);
-    }
-
-    enemies = realloc(enemies, sizeof(Rat) * enemiesCount);
-    Rat* rat = &enemies[enemiesCount - 1];
-    rat->entity = malloc(sizeof(Entity));
-    rat->type = 1;
-    rat->isEnraged = false;
-    rat->entity->position = randomPos;
-    rat->entity->rotation = 0.0f;
-    rat->entity->scale = (Vector2) { 0.5f, 0.5f };
-    rat->entity->velocity = (Vector2) { 0.0f, 0.0f };
-    rat->throwTimer = 0.0f;
-    rat->throwPosition = (Vector2) { 0.0f, 0.0f };
+void DrawFatRat(void) {
+    if (!isFatRatSpawned) return;
+
+    Vector2 position = GetRenderPosition(&fatRat);
+    Vector2 size = GetSpriteSize(SPRITE_FAT_RAT);
+    float w = fatRat.scale.x * SCALE_FACTOR;
+    float h = fatRat.scale.y * SCALE_FACTOR;
+
+    PushSprite(DRAW_LAYER_FAT_RAT, numberOfRatsFed >= 3 ? SPRITE_FAT_RAT_HAPPY : SPRITE_FAT_RAT, (Rectangle) { 0, 0, size.x, size.y },
+               (Rectangle) { position.x, position.y, w, h },
+               (Vector2) { w * 0.5f, h * 0.5f }, fatRat.rotation - 90, WHITE);
 }
 
-void UpdateExplosiveRatSpawner() {
-    if (explosiveRatCount >= LEVELS[currentLevel].maxExplosiveRatCapacity) return;
+void UpdateSpawners(void) {
+    for (int a = 0; a < ARCHETYPE_COUNT; a++) {
+        const ArchetypeDef* def = &ARCHETYPES[a];
+        if (archetypes[a].count >= LEVELS[currentLevel].maxRats[a]) continue;
 
-    explosiveRatSpawnTimer += GetFrameTime();
+        spawnTimers[a] += deltaTime;
+        if (spawnTimers[a] < def->spawnTime) continue;
+        spawnTimers[a] = 0.0f;
 
-    if (explosiveRatSpawnTimer < 10.0f) return;
-    explosiveRatSpawnTimer = 0.0f;
-    explosiveRatCount++;
+        Vector2 randomPos;
+        if (RandomInt(&randomStreams[RANDOM_SPAWN], 2) == 0) {
+            randomPos.x = RandomInt(&randomStreams[RANDOM_SPAWN], (int) BOUNDS_X.y);
+            randomPos.y = RandomInt(&randomStreams[RANDOM_SPAWN], 2) == 0 ? BOUNDS_Y.x : BOUNDS_Y.y;
+            if (def->squeaksOnSpawn) PlaySound(squeakSound3);
+        }
+        else {
+            randomPos.x = RandomInt(&randomStreams[RANDOM_SPAWN], 2) == 0 ? BOUNDS_X.x : BOUNDS_X.y;
+            randomPos.y = RandomInt(&randomStreams[RANDOM_SPAWN], (int) BOUNDS_Y.y);
+            if (def->squeaksOnSpawn) PlaySound(squeakSound2);
+        }
 
-    Vector2 randomPos;
-    if (rand() % 2 == 0) {
-        randomPos.x = rand() % (int) BOUNDS_X.y;
-        randomPos.y = rand() % 2 == 0 ? BOUNDS_Y.x : BOUNDS_Y.y;
-    }
-    else {
-        randomPos.x = rand() % 2 == 0 ? BOUNDS_X.x : BOUNDS_X.y;
-        randomPos.y = rand() % (int) BOUNDS_Y.y;
+        SpawnRat(&archetypes[a], randomPos, 1);
     }
+}
 
-    explosiveRats = realloc(explosiveRats, sizeof(Rat) * explosiveRatCount);
-    Rat* rat = &explosiveRats[explosiveRatCount - 1];
-    rat->entity = malloc(sizeof(Entity));
-    rat->type = 1;
-    rat->entity->position = randomPos;
-    rat->entity->rotation = 0.0f;
-    rat->entity->scale = (Vector2) { 0.5f, 0.5f };
-    rat->entity->velocity = (Vector2) { 0.0f, 0.0f };
-    rat->throwTimer = 0.0f;
-    rat->throwPosition = (Vector2) { 0.0f, 0.0f };
+typedef struct {
+    RatStore* store;
+    const SteerParams* params;
+} SteerJob;
+
+float SteerRatsJob(void* context, int begin, int end) {
+    SteerJob* job = context;
+    return SteerRats(job->store, job->params, begin, end);
 }
 
 void UpdateRats(void) {
-    if (lastBloodLocation.x != 0 && lastBloodLocation.y != 0) {
-        float w = bloodTexture.width;
-        float h = bloodTexture.height;
-        DrawTexturePro(bloodTexture, (Rectangle) { 0, 0, w, h },
-                       (Rectangle) { lastBloodLocation.x, lastBloodLocation.y, w, h },
-                       (Vector2) { w * 0.5f, h * 0.5f }, bloodTextureRotation, WHITE);
+    Vector2 cheesePosition = cheeseEntity.position;
+    int draggedRat = GetRatIndex(rats, currentDraggedRat);
+    int ratOnPlayer = GetRatIndex(rats, currentRatOnPlayer);
+    int ratOnPowerGenerator = GetRatIndex(rats, currentRatOnPowerGenerator);
+
+    // Held rats are skipped by the kernel; the one on the power generator is pinned there below, unless it was
+    // thrown off it and the kernel still has to fly it
+    bool isGeneratorRatThrown = ratOnPowerGenerator >= 0 && rats->throwTimer[ratOnPowerGenerator] > 0.0f;
+    int heldRats[] = { draggedRat, ratOnPlayer, isGeneratorRatThrown ? -1 : ratOnPowerGenerator };
+    for (int k = 0; k < 3; k++) {
+        if (heldRats[k] >= 0) rats->flags[heldRats[k]] |= RAT_HELD;
+    }
+
+    for (int a = 0; a < ARCHETYPE_COUNT; a++) {
+        SteerParams params = {
+            .target = cheesePosition,
+            .deltaTime = deltaTime,
+            .speed = RAT_SPEED,
+            .enragedMultiplier = ENRAGED_SPEED_MULTIPLIER,
+            .throwSpeed = RAT_THROW_SPEED,
+            .arrivalFactor = ARCHETYPES[a].arrivalFactor,
+            .contactFactor = SCALE_FACTOR,
+            .damageRate = CHEESE_DECREASE_RATE * ARCHETYPES[a].damageMultiplier,
+            .alwaysFacesTarget = ARCHETYPES[a].alwaysFacesTarget
+        };
+        SteerJob job = { &archetypes[a], &params };
+        cheese -= ReduceJobs(SteerRatsJob, &job, archetypes[a].count, RAT_JOB_CHUNK_SIZE);
     }
 
-    Vector2 cheesePosition = cheeseEntity.position;
-    for (int i = 0; i < enemiesCount; i++) {
-        Rat* rat = &enemies[i];
-        Entity* entity = rat->entity;
-        if (rat == currentDraggedRat || rat == currentRatOnPlayer) {
-            continue;
-        }
-        if (rat->throwTimer > 0.0f) {
-            rat->throwTimer -= GetFrameTime();
-            Vector2 direction = normalize(getDirection(entity->position, rat->throwPosition));
-            entity->velocity.x = direction.x * 300;
-            entity->velocity.y = direction.y * 300;
-            entity->position.x += entity->velocity.x * GetFrameTime();
-            entity->position.y += entity->velocity.y * GetFrameTime();
-            float w = entity->scale.x * SCALE_FACTOR + cosf(2.0f - rat->throwTimer * 8.0f) * 50;
-            float h = entity->scale.y * SCALE_FACTOR + cosf(2.0f - rat->throwTimer * 8.0f) * 50;
-            Rectangle sourceRec = (Rectangle) { (rat->type - 1) * 256, 0, ratTextureSpritesheet.width / 4.0f, ratTextureSpritesheet.height };
-
-            DrawTexturePro(ratTextureSpritesheet, sourceRec,
-                           (Rectangle) { entity->position.x, entity->position.y, w, h },
-                           (Vector2) { w * 0.5f, h * 0.5f }, entity->rotation - 90, WHITE);
-            continue;
-        }
-        Vector2 direction = normalize(getDirection(entity->position, cheesePosition));
-        entity->velocity.x = direction.x * 100;
-        entity->velocity.y = direction.y * 100;
-        if (rat->isEnraged) {
-            entity->velocity.x *= 2;
-            entity->velocity.y *= 2;
-
-            float w = electricityParticleTexture.width;
-            float h = electricityParticleTexture.height;
-            DrawTexturePro(electricityParticleTexture, (Rectangle) { 0, 0, w, h },
-                           (Rectangle) { entity->position.x, entity->position.y - 25 + rand() % 10 - 5, w * 0.25f, h * 0.25f },
-                           (Vector2) { w * 0.125f, h * 0.125f }, 0, WHITE);
+    for (int k = 0; k < 3; k++) {
+        if (heldRats[k] >= 0) rats->flags[heldRats[k]] &= ~RAT_HELD;
+    }
 
-            w = electricityParticleTexture.width;
-            h = electricityParticleTexture.height;
-            DrawTexturePro(electricityParticleTexture, (Rectangle) { 0, 0, w, h },
-                           (Rectangle) { entity->position.x + 25, entity->position.y - 20 + rand() % 10 - 5, w * 0.25f, h * 0.25f },
-                           (Vector2) { w * 0.125f, h * 0.125f }, 20, WHITE);
+    int i = ratOnPowerGenerator;
+    if (i >= 0 && i != draggedRat && i != ratOnPlayer && !isGeneratorRatThrown) {
+        rats->velocityX[i] = 0;
+        rats->velocityY[i] = 0;
+        SetRatPosition(rats, i, powerGenerator.position);
 
-            w = electricityParticleTexture.width;
-            h = electricityParticleTexture.height;
-            DrawTexturePro(electricityParticleTexture, (Rectangle) { 0, 0, w, h },
-                           (Rectangle) { entity->position.x - 25, entity->position.y - 20 + rand() % 10 - 5, w * 0.25f, h * 0.25f },
-                           (Vector2) { w * 0.125f, h * 0.125f }, -20, WHITE);
-        }
-        //entity->velocity.x += (rand() % 100 - 50) * 0.5f;
-        //entity->velocity.y += (rand() % 100 - 50) * 0.5f;
-        entity->position.x += entity->velocity.x * GetFrameTime() * rat->type;
-        entity->position.y += entity->velocity.y * GetFrameTime() * rat->type;
-
-        if (currentRatOnPowerGenerator == rat && currentDraggedRat != rat) {
-            entity->velocity.x = 0;
-            entity->velocity.y = 0;
-            entity->position.x = powerGenerator.position.x;
-            entity->position.y = powerGenerator.position.y;
+        if (distance(powerGenerator.position, cheesePosition) >= rats->scale[i] * SCALE_FACTOR * 1.5f) {
+            rats->rotation[i] = lookAt(powerGenerator.position, cheesePosition) + 90;
         }
-
-        if (distance(entity->position, cheesePosition) < entity->scale.x * SCALE_FACTOR * 1.5f) {
-            entity->velocity.x = 0;
-            entity->velocity.y = 0;
-        } else {
-            entity->rotation = lookAt(entity->position, cheesePosition) + 90;
+        if (distance(powerGenerator.position, cheesePosition) < rats->scale[i] * SCALE_FACTOR) {
+            cheese -= CHEESE_DECREASE_RATE * deltaTime * rats->type[i];
         }
+    }
 
-        float w = entity->scale.x * SCALE_FACTOR;
-        float h = entity->scale.y * SCALE_FACTOR;
-        Rectangle sourceRec = (Rectangle) { (rat->type - 1) * 256, 0, ratTextureSpritesheet.width / 4.0f, ratTextureSpritesheet.height };
-
-        DrawTexturePro(ratTextureSpritesheet, sourceRec,
-                       (Rectangle) { entity->position.x, entity->position.y, w, h },
-                       (Vector2) { w * 0.5f, h * 0.5f }, entity->rotation - 90, WHITE);
+    // Rats have moved, so the grid is rebuilt for the player contact test and this step's mouse queries
+    BuildSpatialGrid(&ratGrid, rats);
 
-        if (distance(entity->position, player.position) < w && !currentRatOnPlayer) {
-            currentRatOnPlayer = rat;
-            PlaySound(squeakSound1);
+    if (!IsRatAlive(rats, currentRatOnPlayer)) {
+        int climbingRat = -1;
+        int count = QueryGridPoint(&ratGrid, rats, player.position, SCALE_FACTOR);
+        for (int k = 0; k < count; k++) {
+            int i = ratGrid.results[k];
+            if (i == draggedRat || rats->throwTimer[i] > 0.0f) continue;
+            if (climbingRat < 0 || i < climbingRat) climbingRat = i;
         }
 
-        if (distance(entity->position, cheesePosition) < w) {
-            cheese -= CHEESE_DECREASE_RATE * GetFrameTime() * rat->type;
+        if (climbingRat >= 0) {
+            currentRatOnPlayer = GetRatHandle(rats, climbingRat);
+            PlaySound(squeakSound1);
         }
     }
 
-    if (currentRatOnPowerGenerator == NULL) return;
+    if (ratOnPowerGenerator < 0) return;
 
-    powerGeneratorTimer += GetFrameTime();
+    powerGeneratorTimer += deltaTime;
 
     if (powerGeneratorTimer >= POWER_GENERATOR_RAT_ESCAPE_TIME) {
         powerGeneratorTimer = 0.0f;
-        currentRatOnPowerGenerator->isEnraged = true;
-        currentRatOnPowerGenerator = NULL;
+        rats->flags[ratOnPowerGenerator] |= RAT_ENRAGED;
+        currentRatOnPowerGenerator = RAT_HANDLE_NONE;
     }
 }
 
-void UpdateExplosiveRats(void) {
-    Vector2 cheesePosition = cheeseEntity.position;
-    for (int i = 0; i < explosiveRatCount; ++i) {
-        float distanceToCheese = distance(explosiveRats[i].entity->position, cheesePosition);
-
-        if (distanceToCheese < cheeseEntity.scale.x * SCALE_FACTOR) {
-            cheese -= CHEESE_DECREASE_RATE * GetFrameTime() * 2;
-            explosiveRats[i].entity->velocity.x = 0;
-            explosiveRats[i].entity->velocity.y = 0;
-        } else {
-            Vector2 direction = normalize(getDirection(explosiveRats[i].entity->position, cheesePosition));
-            explosiveRats[i].entity->velocity.x = direction.x * 100;
-            explosiveRats[i].entity->velocity.y = direction.y * 100;
-        }
+void DrawRats(void) {
+    if (lastBloodLocation.x != 0 && lastBloodLocation.y != 0) {
+        Vector2 size = GetSpriteSize(SPRITE_BLOOD);
+        PushSprite(DRAW_LAYER_DECALS, SPRITE_BLOOD, (Rectangle) { 0, 0, size.x, size.y },
+                   (Rectangle) { lastBloodLocation.x, lastBloodLocation.y, size.x, size.y },
+                   (Vector2) { size.x * 0.5f, size.y * 0.5f }, bloodTextureRotation, WHITE);
+    }
+
+    Vector2 electricitySize = GetSpriteSize(SPRITE_ELECTRICITY);
+
+    for (int a = 0; a < ARCHETYPE_COUNT; a++) {
+        const ArchetypeDef* def = &ARCHETYPES[a];
+        RatStore* store = &archetypes[a];
+        Vector2 sheetSize = GetSpriteSize(def->sprite);
+        float frameWidth = sheetSize.x / def->frameCount;
+
+        // Held rats are drawn by whoever holds them
+        int draggedRat = def->isGrabbable ? GetRatIndex(store, currentDraggedRat) : -1;
+        int ratOnPlayer = def->isGrabbable ? GetRatIndex(store, currentRatOnPlayer) : -1;
+        for (int i = 0; i < store->count; i++) {
+            if (i == draggedRat || i == ratOnPlayer) {
+                continue;
+            }
+            Vector2 position = GetRatRenderPosition(store, i);
+            Rectangle sourceRec = (Rectangle) { (store->type[i] - 1) % def->frameCount * frameWidth, 0, frameWidth, sheetSize.y };
+            if (store->throwTimer[i] > 0.0f) {
+                float w = store->scale[i] * SCALE_FACTOR + cosf(2.0f - store->throwTimer[i] * 8.0f) * 50;
+                float h = store->scale[i] * SCALE_FACTOR + cosf(2.0f - store->throwTimer[i] * 8.0f) * 50;
+
+                PushSprite(def->layer, def->sprite, sourceRec,
+                           (Rectangle) { position.x, position.y, w, h },
+                           (Vector2) { w * 0.5f, h * 0.5f }, store->rotation[i] - 90, WHITE);
+                continue;
+            }
+            if (store->flags[i] & RAT_ENRAGED) {
+                float w = electricitySize.x;
+                float h = electricitySize.y;
+                PushSprite(DRAW_LAYER_RAT_SPARKS, SPRITE_ELECTRICITY, (Rectangle) { 0, 0, w, h },
+                           (Rectangle) { position.x, position.y - 25 + RandomRange(&randomStreams[RANDOM_RENDER], -5, 5), w * 0.25f, h * 0.25f },
+                           (Vector2) { w * 0.125f, h * 0.125f }, 0, WHITE);
 
-        explosiveRats[i].entity->rotation = lookAt(explosiveRats[i].entity->position, cheesePosition) + 90;
-        explosiveRats[i].entity->position.x += explosiveRats[i].entity->velocity.x * GetFrameTime();
-        explosiveRats[i].entity->position.y += explosiveRats[i].entity->velocity.y * GetFrameTime();
+                PushSprite(DRAW_LAYER_RAT_SPARKS, SPRITE_ELECTRICITY, (Rectangle) { 0, 0, w, h },
+                           (Rectangle) { position.x + 25, position.y - 20 + RandomRange(&randomStreams[RANDOM_RENDER], -5, 5), w * 0.25f, h * 0.25f },
+                           (Vector2) { w * 0.125f, h * 0.125f }, 20, WHITE);
 
-        float w = explosiveRats[i].entity->scale.x * SCALE_FACTOR;
-        float h = explosiveRats[i].entity->scale.y * SCALE_FACTOR;
+                PushSprite(DRAW_LAYER_RAT_SPARKS, SPRITE_ELECTRICITY, (Rectangle) { 0, 0, w, h },
+                           (Rectangle) { position.x - 25, position.y - 20 + RandomRange(&randomStreams[RANDOM_RENDER], -5, 5), w * 0.25f, h * 0.25f },
+                           (Vector2) { w * 0.125f, h * 0.125f }, -20, WHITE);
+            }
 
-        Rectangle sourceRec = (Rectangle) { 0, 0, explosiveRatTexture.width, explosiveRatTexture.height };
-        DrawTexturePro(explosiveRatTexture, sourceRec,
-                       (Rectangle) { explosiveRats[i].entity->position.x, explosiveRats[i].entity->position.y, w, h },
-                       (Vector2) { w * 0.5f, h * 0.5f }, explosiveRats[i].entity->rotation - 90, WHITE);
-    }
-}
+            float w = store->scale[i] * SCALE_FACTOR;
+            float h = store->scale[i] * SCALE_FACTOR;
 
-void DestroyRat(Rat* rat) {
-    for (int i = 0; i < enemiesCount; i++) {
-        if (rat == &enemies[i]) {
-            free(rat->entity);
-            enemies[i] = enemies[enemiesCount - 1];
-            enemiesCount--;
-            enemies = realloc(enemies, sizeof(Rat) * enemiesCount);
-            break;
+            PushSprite(def->layer, def->sprite, sourceRec,
+                       (Rectangle) { position.x, position.y, w, h },
+                       (Vector2) { w * 0.5f, h * 0.5f }, store->rotation[i] - 90, WHITE);
         }
     }
 }
 
-void OnDropRat(Rat* rat) {
-    Vector2 ratPosition = rat->entity->position;
-    float scaleX = rat->entity->scale.x * SCALE_FACTOR;
-    rat->entity->position = (Vector2) {clamp(ratPosition.x, BOUNDS_X.x, BOUNDS_X.y),
-                                       clamp(ratPosition.y, BOUNDS_Y.x, BOUNDS_Y.y)};
+void OnDropRat(RatHandle handle) {
+    int rat = GetRatIndex(rats, handle);
+    if (rat < 0) return;
 
-    if (currentRatOnPowerGenerator == rat) {
-        currentRatOnPowerGenerator = NULL;
-    }
-
-    for (int i = 0; i < enemiesCount; ++i) {
-        if (rat == &enemies[i]) continue;
+    float scaleX = rats->scale[rat] * SCALE_FACTOR;
+    rats->positionX[rat] = clamp(rats->positionX[rat], BOUNDS_X.x, BOUNDS_X.y);
+    rats->positionY[rat] = clamp(rats->positionY[rat], BOUNDS_Y.x, BOUNDS_Y.y);
+    Vector2 ratPosition = GetRatPosition(rats, rat);
 
-        Rat* otherRat = &enemies[i];
-        Entity* otherEntity = otherRat->entity;
-        if (otherRat->type == 4 || rat->type == 4) continue;
-        if (otherRat == currentRatOnPlayer || rat == currentRatOnPlayer) continue;
-        if (otherRat == currentRatOnPowerGenerator || rat == currentRatOnPowerGenerator) continue;
+    if (IsSameRat(currentRatOnPowerGenerator, handle)) {
+        currentRatOnPowerGenerator = RAT_HANDLE_NONE;
+    }
 
-        float distanceToOther = distance(rat->entity->position, otherEntity->position);
+    int ratOnPlayer = GetRatIndex(rats, currentRatOnPlayer);
+    int ratOnPowerGenerator = GetRatIndex(rats, currentRatOnPowerGenerator);
+    int mergedRat = -1;
+    int nearbyCount = QueryGridRadius(&ratGrid, rats, ratPosition, scaleX);
+    for (int k = 0; k < nearbyCount; ++k) {
+        int i = ratGrid.results[k];
+        if (i == rat) continue;
 
-        if (distanceToOther < scaleX) {
-            int highestType = max(rat->type, otherRat->type);
-            rat->type = highestType + 1;
-            rat->entity->scale = (Vector2) { rat->type * 0.25f, rat->type * 0.25f };
-            rat->isEnraged = rat->isEnraged || otherRat->isEnraged;
-            score += 20;
-            DestroyRat(otherRat);
-            PlaySound(poofSound);
+        if (rats->type[i] == 4 || rats->type[rat] == 4) continue;
+        if (i == ratOnPlayer || rat == ratOnPlayer) continue;
+        if (i == ratOnPowerGenerator || rat == ratOnPowerGenerator) continue;
 
-            if (mutateParticlesCount > 0) {
-                free(mutateParticles);
-            }
+        if (mergedRat < 0 || i < mergedRat) mergedRat = i;
+    }
 
-            lastMutationLocation = rat->entity->position;
-            mutateParticles = malloc(sizeof(Entity) * 10);
-            mutateParticlesCount = 10;
-            mutateParticlesTimer = 0.0f;
-
-            for (int j = 0; j < mutateParticlesCount; ++j) {
-                mutateParticles[j] = (Entity) {
-                        .position = lastMutationLocation,
-                        .rotation = 0.0f,
-                        .scale = (Vector2) {0.25f, 0.25f},
-                        .velocity = (Vector2) {0.0f, 0.0f}
-                };
-            }
-            return;
-        }
+    if (mergedRat >= 0) {
+        int highestType = max(rats->type[rat], rats->type[mergedRat]);
+        rats->type[rat] = highestType + 1;
+        rats->scale[rat] = rats->type[rat] * 0.25f;
+        rats->flags[rat] |= rats->flags[mergedRat] & RAT_ENRAGED;
+        score += 20;
+        DespawnRatAt(rats, mergedRat);
+        PlaySound(poofSound);
+        EmitParticles(EMITTER_POOF_SMOKE, ratPosition);
+        EmitParticles(EMITTER_POOF, ratPosition);
+        return;
     }
 
-    if (LEVELS[currentLevel].isFatRatEnabled && (distance(rat->entity->position, fatRat.position) < scaleX && fatRatTimer >= FAT_RAT_SPAWN_TIME)) {
+    if (LEVELS[currentLevel].isFatRatEnabled && (distance(ratPosition, fatRat.position) < scaleX && fatRatTimer >= FAT_RAT_SPAWN_TIME)) {
         numberOfRatsFed++;
 
         score += 5;
-        lastBloodLocation = rat->entity->position;
-        bloodTextureRotation = rat->entity->rotation;
-        bloodParticles = malloc(sizeof(Entity) * 10);
-        bloodParticlesCount = 10;
-        bloodParticlesTimer = 0.0f;
-
-        for (int j = 0; j < bloodParticlesCount; ++j) {
-            bloodParticles[j] = (Entity) {
-                    .position = lastBloodLocation,
-                    .rotation = 0.0f,
-                    .scale = (Vector2) {0.25f, 0.25f},
-                    .velocity = (Vector2) {0.0f, 0.0f}
-            };
-        }
+        lastBloodLocation = ratPosition;
+        bloodTextureRotation = rats->rotation[rat];
+        EmitParticles(EMITTER_BLOOD, ratPosition);
+        EmitParticles(EMITTER_NOM, ratPosition);
 
-        DestroyRat(rat);
+        DespawnRatAt(rats, rat);
         PlaySound(nomSound);
         PlaySound(splatSound);
         return;
@@ -1027,31 +1012,27 @@ void OnDropRat(Rat* rat) {
 
     if (!LEVELS[currentLevel].isPowerGeneratorEnabled) return;
 
-    if (distance(rat->entity->position, powerGenerator.position) < scaleX) {
-        currentRatOnPowerGenerator = rat;
+    if (distance(ratPosition, powerGenerator.position) < scaleX) {
+        currentRatOnPowerGenerator = handle;
         PlaySound(elecSound);
     }
 }
 
 void UpdateMouseLogic(void) {
-    Vector2 mousePosition = GetMousePosition();
-    if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-        for (int i = 0; i < explosiveRatCount; ++i) {
-            if (distance(mousePosition, explosiveRats[i].entity->position) < explosiveRats[i].entity->scale.x * SCALE_FACTOR) {
-                explosiveRatCount--;
-                explosiveRats[i] = explosiveRats[explosiveRatCount];
-                explosiveRats = realloc(explosiveRats, sizeof(Rat) * explosiveRatCount);
-
-                lastExplosionLocation = explosiveRats[i].entity->position;
+    Vector2 mousePosition = input.mousePosition;
+    if (input.isMousePressed) {
+        for (int i = 0; i < explosiveRats->count; ++i) {
+            if (distance(mousePosition, GetRatPosition(explosiveRats, i)) < explosiveRats->scale[i] * SCALE_FACTOR) {
+                EmitParticles(EMITTER_EXPLOSION, GetRatPosition(explosiveRats, i));
+                DespawnRatAt(explosiveRats, i);
                 explosionTimer = 1.0f;
                 score += 5;
 
-                for (int j = 0; j < enemiesCount; ++j) {
-                    float distanceToExplosiveRat = distance(enemies[j].entity->position, mousePosition);
-                    if (distanceToExplosiveRat < 150) {
-                        DestroyRat(&enemies[j]);
-                        PlaySound(explosionSound);
-                    }
+                // Despawning from the highest index down keeps the remaining results valid through swap-removal
+                int caughtCount = QueryGridRadiusOrdered(&ratGrid, rats, mousePosition, 150);
+                for (int k = caughtCount - 1; k >= 0; --k) {
+                    DespawnRatAt(rats, ratGrid.results[k]);
+                    PlaySound(explosionSound);
                 }
 
                 float distanceToCheese = distance(cheeseEntity.position, mousePosition);
@@ -1064,13 +1045,13 @@ void UpdateMouseLogic(void) {
         }
     }
 
-    if (!IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
+    if (!input.isMouseDown) {
         currentHandTexture = 0;
-        if (!IsMouseButtonReleased(MOUSE_LEFT_BUTTON)) return;
-        if (currentDraggedRat != NULL) {
+        if (!input.isMouseReleased) return;
+        if (IsRatAlive(rats, currentDraggedRat)) {
             OnDropRat(currentDraggedRat);
             PlaySound(popSound1);
-            currentDraggedRat = NULL;
+            currentDraggedRat = RAT_HANDLE_NONE;
         }
         else if (isCheeseDragged) {
             isCheeseDragged = false;
@@ -1079,33 +1060,37 @@ void UpdateMouseLogic(void) {
         return;
     }
 
-    if (currentDraggedRat != NULL) {
+    int draggedRat = GetRatIndex(rats, currentDraggedRat);
+    if (draggedRat >= 0) {
         currentHandTexture = 1;
-        currentDraggedRat->entity->position = mousePosition;
-        sanity -= SANITY_DECREASE_RATE * GetFrameTime();
+        SetRatPosition(rats, draggedRat, mousePosition);
+        sanity -= SANITY_DECREASE_RATE * deltaTime;
         return;
     }
 
     if (isCheeseDragged) {
         currentHandTexture = 2;
         cheeseEntity.position = mousePosition;
-        sanity -= SANITY_DECREASE_RATE * GetFrameTime();
+        sanity -= SANITY_DECREASE_RATE * deltaTime;
         return;
     }
 
-    for (int i = 0; i < enemiesCount; i++) {
-        Rat* rat = &enemies[i];
-        if (rat == currentRatOnPlayer || rat->throwTimer > 0.0f) continue;
-        Entity* enemy = rat->entity;
-        float distanceToMouse = distance(enemy->position, GetMousePosition());
-        if (distanceToMouse < enemy->scale.x * SCALE_FACTOR) {
-            currentDraggedRat = rat;
-            PlaySound(popSound2);
-            return;
-        }
+    int ratOnPlayer = GetRatIndex(rats, currentRatOnPlayer);
+    int pickedRat = -1;
+    int pickedCount = QueryGridPoint(&ratGrid, rats, mousePosition, SCALE_FACTOR);
+    for (int k = 0; k < pickedCount; k++) {
+        int i = ratGrid.results[k];
+        if (i == ratOnPlayer || rats->throwTimer[i] > 0.0f) continue;
+        if (pickedRat < 0 || i < pickedRat) pickedRat = i;
+    }
+
+    if (pickedRat >= 0) {
+        currentDraggedRat = GetRatHandle(rats, pickedRat);
+        PlaySound(popSound2);
+        return;
     }
 
-    float distanceToMouse = distance(cheeseEntity.position, GetMousePosition());
+    float distanceToMouse = distance(cheeseEntity.position, mousePosition);
     if (distanceToMouse < cheeseEntity.scale.x * SCALE_FACTOR) {
         isCheeseDragged = true;
         PlaySound(popSound2);
@@ -1113,142 +1098,105 @@ void UpdateMouseLogic(void) {
 }
 
 void UpdateLevel(void) {
-    DrawTexturePro(wallsTexture, (Rectangle) { 0, 0, wallsTexture.width, wallsTexture.height },
-                   (Rectangle) { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT },
-                   (Vector2) { 0, 0 }, 0, WHITE);
-
-    if (LEVELS[currentLevel].isPowerGeneratorEnabled) {
-        DrawTexturePro(powerGeneratorTexture, (Rectangle) { 0, 0, powerGeneratorTexture.width, powerGeneratorTexture.height },
-                       (Rectangle) { powerGenerator.position.x, powerGenerator.position.y, powerGeneratorTexture.width * 0.5f, powerGeneratorTexture.height * 0.5f },
-                       (Vector2) { powerGeneratorTexture.width * 0.25f, powerGeneratorTexture.height * 0.25f }, 0, WHITE);
-    }
-
-    if (currentRatOnPowerGenerator != NULL) {
-        for (int i = 0; i < 10; ++i) {
-            electricityParticles[i].position.y += (rand() % 100 - 50) * GetFrameTime() * 10;
-            if (electricityParticles[i].position.y < powerGenerator.position.y - 50) {
-                electricityParticles[i].position.y = powerGenerator.position.y - 50;
-            } else if (electricityParticles[i].position.y > powerGenerator.position.y + 50) {
-                electricityParticles[i].position.y = powerGenerator.position.y + 50;
-            }
-
-            float w = electricityParticleTexture.width;
-            float h = electricityParticleTexture.height;
-            DrawTexturePro(electricityParticleTexture, (Rectangle) { 0, 0, w, h },
-                           (Rectangle) { electricityParticles[i].position.x, electricityParticles[i].position.y, w * 0.25f, h * 0.25f },
-                           (Vector2) { w * 0.125f, h * 0.125f }, 0, WHITE);
+    // Sparks start afresh whenever a rat lands on the generator and vanish as soon as it leaves
+    bool isGeneratorPowered = IsRatAlive(rats, currentRatOnPowerGenerator);
+    if (isGeneratorPowered != isGeneratorSparking) {
+        isGeneratorSparking = isGeneratorPowered;
+        if (isGeneratorPowered) {
+            EmitParticles(EMITTER_ELECTRICITY, powerGenerator.position);
+        } else {
+            ClearParticles(EMITTER_ELECTRICITY);
         }
     }
 
-    float w = spotlightTexture.width;
-    float h = spotlightTexture.height;
-    Vector2 lightPosition = (Vector2) { player.position.x, player.position.y};
-    DrawTexturePro(spotlightTexture, (Rectangle) { 0, 0, w, h },
-                   (Rectangle) { lightPosition.x, lightPosition.y, w, h },
-                   (Vector2) { w * 0.5f, h * 0.5f }, player.rotation, WHITE);
-
-    DrawRectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, (Color) { 0, 0, 0, 255 - (flashlight * 2.55f) });
-
     if (explosionTimer >= 0.0f) {
-        explosionTimer -= GetFrameTime();
-        float size = cosf(explosionTimer) * 400.0f;
-        DrawTexturePro(explosionTexture, (Rectangle) { 0, 0, explosionTexture.width, explosionTexture.height },
-                       (Rectangle) { lastExplosionLocation.x, lastExplosionLocation.y, size, size },
-                       (Vector2) { size * 0.5f, size * 0.5f }, sinf(GetTime() * 30) * 30.0f, (Color) { 255, 255, 255, explosionTimer * 255 });
+        explosionTimer -= deltaTime;
     }
 
-    if (mutateParticlesTimer >= 1.0f) {
-        mutateParticlesCount = 0;
-    } else {
-        mutateParticlesTimer += GetFrameTime();
-    }
-
-    if (bloodParticlesTimer >= 1.0f) {
-        bloodParticlesCount = 0;
-    } else {
-        bloodParticlesTimer += GetFrameTime();
-    }
+    UpdateParticles(deltaTime);
+}
 
-    if (mutateParticlesCount > 0) {
-        for (int i = 0; i < mutateParticlesCount; ++i) {
-            mutateParticles[i].position.x += rand() % 20 - 10;
-            mutateParticles[i].position.y += rand() % 20 - 10;
+void DrawScreenOverlay(void) {
+    DrawOverlay(&overlay);
+}
 
-            DrawCircle(mutateParticles[i].position.x, mutateParticles[i].position.y,
-                       50.0f - 50.0f * mutateParticlesTimer,
-                       (Color) {255, 255, 255, 255 - mutateParticlesTimer * 255});
-        }
+void DrawLevel(void) {
+    PushTexture(DRAW_LAYER_WALLS, wallsTexture, (Rectangle) { 0, 0, wallsTexture.width, wallsTexture.height },
+                (Rectangle) { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT },
+                (Vector2) { 0, 0 }, 0, WHITE);
 
-        float size = sinf(mutateParticlesTimer * 6.0f) * 150.0f + 150.0f;
-        DrawTexturePro(poofTexture, (Rectangle) {0, 0, poofTexture.width, poofTexture.height},
-                       (Rectangle) {lastMutationLocation.x, lastMutationLocation.y, size, size},
-                       (Vector2) {size * 0.5f, size * 0.5f}, sinf(mutateParticlesTimer * 5.0f) * 30.0f - 30.0f,
-                       (Color) {255, 255, 255, min(255, 512 - mutateParticlesTimer * 512)});
+    if (LEVELS[currentLevel].isPowerGeneratorEnabled) {
+        Vector2 size = GetSpriteSize(SPRITE_POWER_GENERATOR);
+        PushSprite(DRAW_LAYER_POWER_GENERATOR, SPRITE_POWER_GENERATOR, (Rectangle) { 0, 0, size.x, size.y },
+                   (Rectangle) { powerGenerator.position.x, powerGenerator.position.y, size.x * 0.5f, size.y * 0.5f },
+                   (Vector2) { size.x * 0.25f, size.y * 0.25f }, 0, WHITE);
     }
 
-    if (bloodParticlesCount > 0) {
-        for (int i = 0; i < bloodParticlesCount; ++i) {
-            bloodParticles[i].position.x += rand() % 20 - 10;
-            bloodParticles[i].position.y += rand() % 20 - 10;
+    DrawParticles();
 
-            DrawCircle(bloodParticles[i].position.x, bloodParticles[i].position.y,
-                       50.0f - 50.0f * bloodParticlesTimer,
-                       (Color) {180, 0, 0, 255 - bloodParticlesTimer * 255});
-        }
+    unsigned char darkness = 255 - (flashlight * 2.55f);
+    overlay = (OverlayParams) {
+        .lightPosition = GetRenderPosition(&player),
+        .lightRotation = player.rotation,
+        .darkness = darkness / 255.0f,
+        .teethMaxOffset = FAT_RAT_TEETH_MAX_POSITION
+    };
+    PushCallback(DRAW_LAYER_OVERLAY, DrawScreenOverlay);
 
-        float size = sinf(bloodParticlesTimer * 6.0f) * 100.0f + 100.0f;
-        DrawTexturePro(nomTexture, (Rectangle) {0, 0, nomTexture.width, nomTexture.height},
-                       (Rectangle) {lastBloodLocation.x, lastBloodLocation.y, size, size},
-                       (Vector2) {size * 0.5f, size * 0.5f}, sinf(bloodParticlesTimer * 5.0f) * 30.0f - 10.0f,
-                       (Color) {255, 0, 0, min(255, 512 - bloodParticlesTimer * 512)});
+    // Fully dark, so let the draw list skip everything underneath
+    if (darkness == 255) {
+        PushRectangle(DRAW_LAYER_DARKNESS, (Rectangle) { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT }, BLACK);
     }
 }
 
 void UpdateScreenEffects(void) {
     if (isScreenFlickering) {
-        screenFlickerTimer += GetFrameTime();
+        screenFlickerTimer += deltaTime;
         if (screenFlickerTimer >= 1.0f) {
             screenFlickerTimer = 0.0f;
             isScreenFlickering = false;
         }
-        DrawRectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, (Color) { 0, 0, 0, sinf(screenFlickerTimer * 25) * 255 });
     }
     else if (sanity <= 50.0f) {
-        screenFlickerTimer += GetFrameTime();
+        screenFlickerTimer += deltaTime;
         if (screenFlickerTimer >= SCREEN_FLICKER_TIME) {
             screenFlickerTimer = 0.0f;
             isScreenFlickering = true;
         }
     }
 
+    if (redFlashIntensity > 0.0f) {
+        redFlashIntensity -= deltaTime;
+    }
+}
+
+void DrawScreenEffects(void) {
+    if (isScreenFlickering) {
+        unsigned char flicker = sinf(screenFlickerTimer * 25) * 255;
+        overlay.flicker = flicker / 255.0f;
+    }
+
     if (explosionTimer > 0.0f) {
-        DrawRectangle(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, (Color) { 255, 255, 255, explosionTimer * 128 });
+        unsigned char flash = explosionTimer * 128;
+        overlay.flash = flash / 255.0f;
     }
 
     if (redFlashIntensity > 0.0f) {
-        redFlashIntensity -= GetFrameTime();
-        DrawTexturePro(redFlashTexture, (Rectangle) { 0, 0, redFlashTexture.width, redFlashTexture.height },
-                       (Rectangle) { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT },
-                       (Vector2) { 0, 0 }, 0, (Color) { 255, 255, 255, redFlashIntensity * 255 });
+        unsigned char red = redFlashIntensity * 255;
+        overlay.redIntensity = red / 255.0f;
     }
 
-    if (currentRatOnPlayer != NULL && currentLevel <= 2) {
-        DrawTexturePro(spaceButtonTexture, (Rectangle) { 0, 0, spaceButtonTexture.width, spaceButtonTexture.height },
-                       (Rectangle) { SCREEN_WIDTH * 0.5f, SCREEN_HEIGHT * 0.875f + sinf(GetTime() * 20) * 10, 300, 300 },
-                       (Vector2) { 150, 150 }, 0, WHITE);
-    }
+    overlay.teethOffset = fatRatTeethPosition;
 
-    float w = fatRatTeeth.width;
-    float h = fatRatTeeth.height;
-    DrawTexturePro(fatRatTeeth, (Rectangle) { 0, 0, w, h },
-                   (Rectangle) { SCREEN_WIDTH * 0.5f, fatRatTeethPosition - FAT_RAT_TEETH_MAX_POSITION, SCREEN_WIDTH, SCREEN_HEIGHT },
-                   (Vector2) { w * 0.5f, h * 0.5f }, 0, WHITE);
-    DrawTexturePro(fatRatTeeth, (Rectangle) { 0, 0, w, h },
-                   (Rectangle) { SCREEN_WIDTH * 0.5f, SCREEN_HEIGHT - fatRatTeethPosition + FAT_RAT_TEETH_MAX_POSITION, SCREEN_WIDTH, SCREEN_HEIGHT },
-                   (Vector2) { w * 0.5f, h * 0.5f }, 180, WHITE);
+    if (IsRatAlive(rats, currentRatOnPlayer) && currentLevel <= 2) {
+        Vector2 size = GetSpriteSize(SPRITE_SPACE_BUTTON);
+        PushSprite(DRAW_LAYER_PROMPT, SPRITE_SPACE_BUTTON, (Rectangle) { 0, 0, size.x, size.y },
+                   (Rectangle) { SCREEN_WIDTH * 0.5f, SCREEN_HEIGHT * 0.875f + sinf(GetTime() * 20) * 10, 300, 300 },
+                   (Vector2) { 150, 150 }, 0, WHITE);
+    }
 }
 
-void UpdateUI(void) {
+void DrawUI(void) {
     DrawText(TextFormat("Score: %i", score), 10, 10, 20, WHITE);
     DrawText(TextFormat("Highscore: %i", highscore), 10, 30, 20, WHITE);
 
@@ -1339,9 +1287,9 @@ void RestartMenu(void) {
     }
     else SetMouseCursor(MOUSE_CURSOR_DEFAULT);
 
-    if ((!submittedScore && (mouseOverSubmitButton && IsMouseButtonDown(MOUSE_LEFT_BUTTON))) && usernameSize > 0) {
-        submittedScore = true;
-        UploadNewEntry();
+    bool isSubmitted = IsLeaderboardScorePending(username, highscore);
+    if ((!isSubmitted && (mouseOverSubmitButton && IsMouseButtonDown(MOUSE_LEFT_BUTTON))) && usernameSize > 0) {
+        SubmitLeaderboardScore(username, highscore);
     }
 
     if (mouseOverRestartButton && IsMouseButtonDown(MOUSE_LEFT_BUTTON)) {
@@ -1366,7 +1314,7 @@ void RestartMenu(void) {
         DrawText("|", inputField.x + 8 + MeasureText(username, 40), inputField.y + 12, 40, BLUE);
 
     char *submitText = "Submit highscore";
-    if (!submittedScore) {
+    if (!isSubmitted) {
         DrawRectangleRec(submitButton, WHITE);
         DrawRectangleLinesEx((Rectangle) {submitButton.x, submitButton.y, submitButton.width, submitButton.height},
                              2.0f,
@@ -1384,7 +1332,10 @@ void RestartMenu(void) {
 
 void OnGameOver(void) {
     UpdateLevel();
-    UpdateUI();
+    BeginDrawList(&frameArena);
+    DrawLevel();
+    SubmitDrawList((Rectangle) { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT });
+    DrawUI();
     currentHandTexture = 0;
     Vector2 gameOverTextSize = MeasureTextEx(GetFontDefault(), "Game Over", 100, 10);
     DrawTextEx(GetFontDefault(), "Game Over",
@@ -1394,13 +1345,14 @@ void OnGameOver(void) {
     RestartMenu();
 }
 
-void UpdateCursor(void) {
-    Vector2 mousePos = GetMousePosition();
+void DrawCursor(void) {
+    Vector2 mousePos = IsReplayingInput() ? input.mousePosition : GetMousePosition();
 
-    Texture2D texture = handTextures[currentHandTexture];
-    DrawTexturePro(texture, (Rectangle) { 0, 0, texture.width, texture.height },
-                   (Rectangle) { mousePos.x, mousePos.y, texture.width * 0.5f, texture.height * 0.5f },
-                   (Vector2) { texture.width * 0.25f, texture.height * 0.25f }, 0, WHITE);
+    SpriteId hand = SPRITE_HAND + currentHandTexture;
+    Vector2 size = GetSpriteSize(hand);
+    DrawSprite(hand, (Rectangle) { 0, 0, size.x, size.y },
+               (Rectangle) { mousePos.x, mousePos.y, size.x * 0.5f, size.y * 0.5f },
+               (Vector2) { size.x * 0.25f, size.y * 0.25f }, 0, WHITE);
 }
 
 void OnEnding(void) {
@@ -1436,7 +1388,7 @@ void OnEnding(void) {
                    (Vector2) { SCREEN_WIDTH / 2 - highscoreTextSize.x / 2, SCREEN_HEIGHT / 2 - highscoreTextSize.y / 2 + 100 },
                    50, 5, WHITE);
         RestartMenu();
-        UpdateCursor();
+        DrawCursor();
     }
 }
 
@@ -1478,6 +1430,60 @@ void LevelTransition(void) {
 
 static bool isStarted = false;
 
+void Simulate(void) {
+    SnapshotEntities();
+    PROFILE(PROFILE_GRID, BuildSpatialGrid(&ratGrid, rats));
+    PROFILE(PROFILE_STATS, UpdateStats());
+    PROFILE(PROFILE_CHEESE, UpdateCheese());
+    PROFILE(PROFILE_SPAWNERS, UpdateSpawners());
+    PROFILE(PROFILE_RATS, UpdateRats());
+    PROFILE(PROFILE_PLAYER, UpdatePlayer());
+
+    if (LEVELS[currentLevel].isFatRatEnabled)
+        PROFILE(PROFILE_FAT_RAT, UpdateFatRat());
+
+    PROFILE(PROFILE_MOUSE, UpdateMouseLogic());
+    PROFILE(PROFILE_LEVEL, UpdateLevel());
+    PROFILE(PROFILE_SCREEN_EFFECTS, UpdateScreenEffects());
+
+    ConsumeInputEdges();
+    gameTime += deltaTime;
+}
+
+// World drawing only records commands; they are sorted, culled and drawn together once the frame is assembled
+void DrawGame(void) {
+    PROFILE_BEGIN(PROFILE_DRAW_WORLD);
+    BeginDrawList(&frameArena);
+    DrawCheese();
+    DrawRats();
+    DrawPlayer();
+
+    if (LEVELS[currentLevel].isFatRatEnabled)
+        DrawFatRat();
+
+    DrawLevel();
+    DrawScreenEffects();
+    PROFILE_END(PROFILE_DRAW_WORLD);
+    PROFILE(PROFILE_DRAW_SUBMIT, SubmitDrawList((Rectangle) { 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT }));
+
+    PROFILE_BEGIN(PROFILE_DRAW_UI);
+    DrawUI();
+    DrawCursor();
+    PROFILE_END(PROFILE_DRAW_UI);
+
+#if defined(CRAZY_PROFILER)
+    DrawListStats drawStats = GetDrawListStats();
+    PROFILE_COUNT(PROFILE_DRAW_COMMANDS, drawStats.pushed);
+    PROFILE_COUNT(PROFILE_DRAW_CULLED, drawStats.culled);
+    PROFILE_COUNT(PROFILE_DRAW_BATCHES, drawStats.textureSwitches);
+    PROFILE_COUNT(PROFILE_RAT_COUNT, rats->count);
+    PROFILE_COUNT(PROFILE_EXPLOSIVE_RAT_COUNT, explosiveRats->count);
+    PROFILE_COUNT(PROFILE_PARTICLE_COUNT, GetParticleCount());
+    PROFILE_COUNT(PROFILE_FRAME_ARENA_KB, (int) (frameArena.used / 1024));
+    PROFILE_COUNT(PROFILE_LEVEL_ARENA_KB, (int) (levelArena.used / 1024));
+#endif
+}
+
 void StartScreen(void) {
     ClearBackground(BLACK);
 
@@ -1496,30 +1502,100 @@ void StartScreen(void) {
                (Vector2) { SCREEN_WIDTH / 2 - creditsTextSize.x / 2, SCREEN_HEIGHT * 0.875f},
                20, 2, GRAY);
 
-    if (IsKeyPressed(KEY_ENTER)) {
+    if (!IsAssetStageReady(ASSET_STAGE_COUNT - 1)) {
+        DrawRectangle(0, SCREEN_HEIGHT - 4, SCREEN_WIDTH * GetAssetProgress(ASSET_STAGE_COUNT - 1), 4, DARKGRAY);
+    }
+
+    if (IsKeyPressed(KEY_ENTER) && IsAssetStageReady(ASSET_STAGE_START)) {
         isStarted = true;
         PlaySound(crazySound);
     }
 }
 
+// Holds a state back until the assets it first uses have loaded, showing their progress meanwhile
+bool AwaitAssets(AssetStage stage) {
+    if (IsAssetStageReady(stage)) return true;
+
+    ClearBackground(BLACK);
+    Vector2 textSize = MeasureTextEx(GetFontDefault(), "Loading...", 50, 5);
+    DrawTextEx(GetFontDefault(), "Loading...",
+               (Vector2) { SCREEN_WIDTH / 2 - textSize.x / 2, SCREEN_HEIGHT / 2 - textSize.y / 2 },
+               50, 5, GRAY);
+    DrawRectangle(SCREEN_WIDTH / 4, SCREEN_HEIGHT / 2 + textSize.y, SCREEN_WIDTH / 2 * GetAssetProgress(stage), 8, GRAY);
+    return false;
+}
+
+static bool isReplayLevelStarted = false;
+
+// Plays back one frame's worth of recorded steps, starting recorded levels as the log reaches them
+bool ReplayStep(void) {
+    LevelStart levelStart;
+    InputLogEvent event;
+    while ((event = ReadInputLog(&input, &levelStart)) == INPUT_LOG_LEVEL_START) {
+        isGameOver = false;
+        isLevelTransitioning = false;
+        isFinishedGame = false;
+        currentLevel = levelStart.level;
+        ResetLevelWithSeed(levelStart.fullRestart, levelStart.seed);
+        isReplayLevelStarted = true;
+    }
+    if (event == INPUT_LOG_END) return false;
+
+    // Steps before any level start would run on whatever seed this session happened to have
+    if (!isReplayLevelStarted) {
+        TraceLog(LOG_WARNING, "INPUTLOG: Log does not start with a level start, so it cannot be replayed");
+        return false;
+    }
+
+    Simulate();
+    return true;
+}
+
+void UpdateReplay(void) {
+    PROFILE(PROFILE_AUDIO, UpdateMusicStream(ambienceMusic));
+
+    deltaTime = FIXED_TIMESTEP;
+    simulationAccumulator += min(GetFrameTime(), MAX_FRAME_TIME);
+    int steps = 0;
+    while (simulationAccumulator >= FIXED_TIMESTEP) {
+        if (!ReplayStep()) {
+            CloseInputLog();
+            break;
+        }
+        simulationAccumulator -= FIXED_TIMESTEP;
+        steps++;
+    }
+    PROFILE_COUNT(PROFILE_STEPS, steps);
+    renderAlpha = clamp(simulationAccumulator / FIXED_TIMESTEP, 0.0f, 1.0f);
+
+    DrawGame();
+}
+
 void Update(void) {
+    if (IsReplayingInput()) {
+        if (AwaitAssets(ASSET_STAGE_GAME)) UpdateReplay();
+        return;
+    }
+
+    deltaTime = GetFrameTime();
     if (!isStarted) {
         StartScreen();
-        UpdateMusicStream(cutsceneMusic);
+        PROFILE(PROFILE_AUDIO, UpdateMusicStream(cutsceneMusic));
         return;
     }
     if (isFinishedGame) {
-        OnEnding();
+        if (AwaitAssets(ASSET_STAGE_ENDING)) OnEnding();
         return;
     }
     if (isCutscenePlaying) {
-        UpdateCutscenes();
-        UpdateMusicStream(cutsceneMusic);
+        if (AwaitAssets(ASSET_STAGE_CUTSCENE)) UpdateCutscenes();
+        PROFILE(PROFILE_AUDIO, UpdateMusicStream(cutsceneMusic));
         return;
     }
+    if (!AwaitAssets(ASSET_STAGE_GAME)) return;
     if (isGameOver) {
         OnGameOver();
-        UpdateCursor();
+        DrawCursor();
         if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
             PlaySound(popSound2);
         }
@@ -1529,53 +1605,392 @@ void Update(void) {
         LevelTransition();
         return;
     }
-    UpdateMusicStream(ambienceMusic);
-    UpdateStats();
-    UpdateCheese();
-    UpdateExplosiveRatSpawner();
-    UpdateExplosiveRats();
-    UpdateRatSpawner();
-    UpdateRats();
-    UpdatePlayer();
+    PROFILE(PROFILE_AUDIO, UpdateMusicStream(ambienceMusic));
+    PollInput();
 
-    if (LEVELS[currentLevel].isFatRatEnabled)
-        UpdateFatRat();
+    deltaTime = FIXED_TIMESTEP;
+    simulationAccumulator += min(GetFrameTime(), MAX_FRAME_TIME);
+    int steps = 0;
+    while (simulationAccumulator >= FIXED_TIMESTEP && !isGameOver && !isLevelTransitioning) {
+        RecordInputStep(&input);
+        Simulate();
+        simulationAccumulator -= FIXED_TIMESTEP;
+        steps++;
+    }
+    PROFILE_COUNT(PROFILE_STEPS, steps);
+    renderAlpha = clamp(simulationAccumulator / FIXED_TIMESTEP, 0.0f, 1.0f);
 
-    UpdateMouseLogic();
-    UpdateLevel();
-    UpdateScreenEffects();
-    UpdateUI();
-    UpdateCursor();
+    DrawGame();
 }
 
-void MainLoop(void) {
-    while (!WindowShouldClose()) {
-        ClearBackground(BACKGROUND_COLOR);
-        BeginDrawing();
-        Update();
-        EndDrawing();
-    }
+// One frame of the windowed game, called by the native loop and by the browser once per animation frame
+void Frame(void) {
+    PROFILE_BEGIN(PROFILE_FRAME);
+    if (IsKeyPressed(KEY_F3)) PROFILE_TOGGLE_OVERLAY();
+    ResetArena(&frameArena);
+    PROFILE(PROFILE_ASSETS, UpdateAssetLoading(ASSET_UPLOAD_BUDGET));
+    PollHttp();
+    UpdateLeaderboard();
+
+    ClearBackground(BACKGROUND_COLOR);
+    BeginDrawing();
+    Update();
+    PROFILE_DRAW_OVERLAY();
+    PROFILE(PROFILE_END_DRAWING, EndDrawing());
+
+    PROFILE_END(PROFILE_FRAME);
+    PROFILE_FRAME();
+}
+
+void Shutdown(void) {
+    CloseInputLog();
+    ShutdownHttp();
     UnloadMusicStream(ambienceMusic);
     UnloadMusicStream(cutsceneMusic);
+    UnloadAssets();
+    UnloadArena(&frameArena);
+    UnloadArena(&levelArena);
+    UnloadOverlay();
+    UnloadSprites();
+    CloseArchive();
+    ShutdownJobs();
     CloseAudioDevice();
 }
 
-int main(void) {
-    srand(time(NULL));
+#pragma region Headless
+
+static int headlessLevel = -1;
+static int headlessRuns = HEADLESS_DEFAULT_RUNS;
+static const char* recordPath = NULL;
+static const char* replayPath = NULL;
+static bool hasSeed = false;
+static uint64_t sessionSeed = 0;
+static float soakHours = 0.0f;
+static float soakMaxResidentGrowth = SOAK_DEFAULT_MAX_RSS_GROWTH;
+static float soakMaxDrift = SOAK_DEFAULT_MAX_DRIFT;
+static int jobThreads = 0;
+
+void BeginHeadlessRun(int level) {
+    isGameOver = false;
+    isLevelTransitioning = false;
+    currentLevel = level;
+    ResetLevel(false);
+    health = 100.0f;
+    score = 0;
+    scoreTimer = 0.0f;
+}
+
+// FNV-1a over the simulation state, so that two builds replaying one log can be checked for identical results
+uint32_t HashSimulationState(void) {
+    uint32_t hash = 2166136261u;
+#define HASH_BYTES(data, size) \
+    for (size_t b = 0; b < (size); b++) hash = (hash ^ ((const uint8_t*) (data))[b]) * 16777619u;
+
+    HASH_BYTES(&player.position, sizeof(Vector2));
+    HASH_BYTES(&cheeseEntity.position, sizeof(Vector2));
+    HASH_BYTES(&fatRat.position, sizeof(Vector2));
+    HASH_BYTES(&cheese, sizeof(float));
+    HASH_BYTES(&sanity, sizeof(float));
+    HASH_BYTES(&health, sizeof(float));
+    HASH_BYTES(&score, sizeof(int));
+    for (int a = 0; a < ARCHETYPE_COUNT; a++) {
+        HASH_BYTES(archetypes[a].positionX, sizeof(float) * archetypes[a].count);
+        HASH_BYTES(archetypes[a].positionY, sizeof(float) * archetypes[a].count);
+        HASH_BYTES(archetypes[a].type, sizeof(int) * archetypes[a].count);
+    }
+#undef HASH_BYTES
+    return hash;
+}
+
+int RunHeadlessReplay(void) {
+    if (!BeginInputReplay(replayPath)) return 1;
+
+    InitEntities();
+    deltaTime = FIXED_TIMESTEP;
+
+    long stepCount = 0;
+    clock_t startClock = clock();
+    while (ReplayStep()) stepCount++;
+    CloseInputLog();
+    if (!isReplayLevelStarted) return 1;
+
+    double seconds = (double) (clock() - startClock) / CLOCKS_PER_SEC;
+    printf("Replayed %li steps, ended on level %i: score %i, cheese %.1f, sanity %.1f, health %.1f, state %08x\n",
+           stepCount, currentLevel, score, cheese, sanity, health, HashSimulationState());
+    printf("%.3fs (%.0f steps/s)\n", seconds, seconds > 0.0 ? stepCount / seconds : 0.0);
+    return 0;
+}
+
+typedef struct {
+    RandomStream random;
+    int holdSteps;
+    int idleSteps;
+    Vector2 target;
+} SoakBot;
+
+static double soakClock(void) {
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+// Plays like a restless player: grabs rats and drags them onto other rats, the fat rat or the generator,
+// clicks explosive rats, wanders around and throws whatever is on the player
+void DriveSoakBot(SoakBot* bot) {
+    RandomStream* rng = &bot->random;
+    if (RandomInt(rng, SIMULATION_RATE) == 0) {
+        input.isMovingUp = RandomInt(rng, 3) == 0;
+        input.isMovingDown = !input.isMovingUp && RandomInt(rng, 2) == 0;
+        input.isMovingLeft = RandomInt(rng, 3) == 0;
+        input.isMovingRight = !input.isMovingLeft && RandomInt(rng, 2) == 0;
+    }
+    input.isThrowPressed = RandomInt(rng, SIMULATION_RATE * 4) == 0;
+
+    if (input.isMouseDown) {
+        Vector2 toTarget = getDirection(input.mousePosition, bot->target);
+        float remaining = sqrtf(toTarget.x * toTarget.x + toTarget.y * toTarget.y);
+        float step = 600.0f * deltaTime;
+        if (remaining > step) {
+            input.mousePosition.x += toTarget.x / remaining * step;
+            input.mousePosition.y += toTarget.y / remaining * step;
+        } else {
+            input.mousePosition = bot->target;
+        }
+
+        if (--bot->holdSteps <= 0) {
+            input.isMouseDown = false;
+            input.isMouseReleased = true;
+            bot->idleSteps = RandomInt(rng, SIMULATION_RATE);
+        }
+        return;
+    }
+    if (--bot->idleSteps > 0) return;
+
+    RatStore* store = explosiveRats->count > 0 && RandomInt(rng, 4) == 0 ? explosiveRats : rats;
+    if (store->count == 0) {
+        bot->idleSteps = SIMULATION_RATE / 4;
+        return;
+    }
+    input.mousePosition = GetRatPosition(store, RandomInt(rng, store->count));
+    input.isMouseDown = true;
+    input.isMousePressed = true;
+    bot->holdSteps = SIMULATION_RATE / 4 + RandomInt(rng, SIMULATION_RATE / 2);
+
+    switch (RandomInt(rng, 4)) {
+        case 0:
+            bot->target = fatRat.position;
+            break;
+        case 1:
+            bot->target = powerGenerator.position;
+            break;
+        case 2:
+            bot->target = rats->count > 0 ? GetRatPosition(rats, RandomInt(rng, rats->count)) : cheeseEntity.position;
+            break;
+        default:
+            bot->target = (Vector2) { RandomRange(rng, BOUNDS_X.x, BOUNDS_X.y), RandomRange(rng, BOUNDS_Y.x, BOUNDS_Y.y) };
+            break;
+    }
+}
+
+// Losing moves on to the next level so that every level keeps being played; the last one ends in a full restart
+bool AdvanceSoakSession(void) {
+    int levelCount = sizeof(LEVELS) / sizeof(LEVELS[0]);
+    bool isFullRestart = currentLevel + 1 >= levelCount;
 
+    isGameOver = false;
+    isLevelTransitioning = false;
+    input = (GameInput) { 0 };
+    if (isFullRestart) {
+        score = 0;
+        ResetLevel(true);
+    } else {
+        currentLevel++;
+        ResetLevel(false);
+        health = 100.0f;
+    }
+    return isFullRestart;
+}
+
+// Plays for soakHours of simulated time, logging resource use per simulated minute as CSV. Fails when the
+// live allocation count or resident size grows past warm-up, or when steps end up slower than they started.
+int RunSoak(void) {
+    InitEntities();
+    deltaTime = FIXED_TIMESTEP;
+
+    SoakBot bot = { 0 };
+    SeedRandom(&bot.random, NextRandom(&sessionRandom), 0);
+    ResetLevel(true);
+    isGameOver = false;
+    isLevelTransitioning = false;
+
+    int minimumWindows = SOAK_WARMUP_WINDOWS + SOAK_DRIFT_WINDOWS * 2;
+    int windowCount = max(minimumWindows, (int) (soakHours * 3600.0f * SIMULATION_RATE / SOAK_WINDOW_STEPS));
+    double* stepTimes = TrackedMalloc(sizeof(double) * windowCount);
+
+    HeapStats baselineHeap = { 0 };
+    size_t baselineResident = 0;
+    long levelStarts = 1;
+    long fullRestarts = 1;
+    const char* failure = NULL;
+
+    printf("minute,rss_mb,live_allocations,heap_calls,step_us,level\n");
+    for (int window = 0; window < windowCount && failure == NULL; window++) {
+        double start = soakClock();
+        for (int step = 0; step < SOAK_WINDOW_STEPS; step++) {
+            DriveSoakBot(&bot);
+            Simulate();
+            if (isGameOver || isLevelTransitioning) {
+                fullRestarts += AdvanceSoakSession();
+                levelStarts++;
+            }
+        }
+        stepTimes[window] = (soakClock() - start) / SOAK_WINDOW_STEPS;
+
+        HeapStats heap = GetHeapStats();
+        size_t resident = GetResidentBytes();
+        printf("%i,%.1f,%li,%li,%.3f,%i\n", window + 1, resident / 1048576.0, heap.liveAllocations, heap.heapCalls,
+               stepTimes[window] * 1e6, currentLevel);
+
+        if (window + 1 == SOAK_WARMUP_WINDOWS) {
+            baselineHeap = heap;
+            baselineResident = resident;
+        } else if (window + 1 > SOAK_WARMUP_WINDOWS) {
+            if (heap.liveAllocations - baselineHeap.liveAllocations > SOAK_MAX_ALLOCATION_GROWTH) {
+                failure = "live allocations grew";
+            } else if (resident > baselineResident && (resident - baselineResident) / 1048576.0 > soakMaxResidentGrowth) {
+                failure = "resident size grew";
+            }
+        }
+    }
+
+    double earlyStep = 0.0, lateStep = 0.0;
+    int lastWindow = failure == NULL ? windowCount : 0;
+    for (int i = 0; i < SOAK_DRIFT_WINDOWS && lastWindow > 0; i++) {
+        earlyStep += stepTimes[SOAK_WARMUP_WINDOWS + i] / SOAK_DRIFT_WINDOWS;
+        lateStep += stepTimes[lastWindow - 1 - i] / SOAK_DRIFT_WINDOWS;
+    }
+    double drift = earlyStep > 0.0 ? lateStep / earlyStep : 1.0;
+    if (failure == NULL && drift > soakMaxDrift) failure = "step time drifted";
+
+    HeapStats heap = GetHeapStats();
+    printf("# %.2f simulated hours, %li level starts, %li full restarts\n",
+           (double) windowCount * SOAK_WINDOW_STEPS / SIMULATION_RATE / 3600.0, levelStarts, fullRestarts);
+    printf("# rss %.1f -> %.1f MB, live allocations %li -> %li, %li heap calls after warm-up, step %.3f -> %.3f us (x%.2f)\n",
+           baselineResident / 1048576.0, GetResidentBytes() / 1048576.0, baselineHeap.liveAllocations, heap.liveAllocations,
+           heap.heapCalls - baselineHeap.heapCalls, earlyStep * 1e6, lateStep * 1e6, drift);
+    printf("# %s%s\n", failure == NULL ? "PASS" : "FAIL: ", failure == NULL ? "" : failure);
+
+    TrackedFree(stepTimes);
+    return failure == NULL ? 0 : 1;
+}
+
+int RunHeadless(void) {
+    if (soakHours > 0.0f) return RunSoak();
+    if (replayPath != NULL) return RunHeadlessReplay();
+
+    int levelCount = sizeof(LEVELS) / sizeof(LEVELS[0]);
+    int firstLevel = headlessLevel >= 0 ? headlessLevel : 0;
+    int lastLevel = headlessLevel >= 0 ? headlessLevel : levelCount - 1;
+    if (firstLevel >= levelCount) {
+        printf("Level %i does not exist, there are %i levels.\n", firstLevel, levelCount);
+        return 1;
+    }
+
+    InitEntities();
+    deltaTime = FIXED_TIMESTEP;
+
+    int runCount = 0;
+    int survivedCount = 0;
+    long frameCount = 0;
+    clock_t startClock = clock();
+
+    for (int level = firstLevel; level <= lastLevel; level++) {
+        for (int run = 0; run < headlessRuns; run++) {
+            BeginHeadlessRun(level);
+            while (!isGameOver && !isLevelTransitioning) {
+                Simulate();
+                frameCount++;
+            }
+
+            runCount++;
+            if (!isGameOver) survivedCount++;
+            printf("Level %i run %i: %s at %.2fs, score %i, cheese %.1f, sanity %.1f, health %.1f\n",
+                   level, run, isGameOver ? "lost" : "survived", currentTime, isGameOver ? runScore : score, cheese, sanity, health);
+        }
+    }
+
+    double seconds = (double) (clock() - startClock) / CLOCKS_PER_SEC;
+    printf("%i runs, %i survived, %li frames simulated in %.3fs (%.0f frames/s)\n",
+           runCount, survivedCount, frameCount, seconds, seconds > 0.0 ? frameCount / seconds : 0.0);
+    return 0;
+}
+
+#pragma endregion
+
+void ParseArguments(int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            isHeadless = true;
+        } else if (strcmp(argv[i], "--level") == 0 && i + 1 < argc) {
+            headlessLevel = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+            headlessRuns = max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            hasSeed = true;
+            sessionSeed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--soak") == 0 && i + 1 < argc) {
+            isHeadless = true;
+            soakHours = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--soak-rss") == 0 && i + 1 < argc) {
+            soakMaxResidentGrowth = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--soak-drift") == 0 && i + 1 < argc) {
+            soakMaxDrift = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobThreads = max(1, atoi(argv[++i]));
+        } else if (strcmp(argv[i], "--leaderboard") == 0 && i + 1 < argc) {
+            leaderboardUrl = argv[++i];
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    ParseArguments(argc, argv);
+    SeedSessionRandom(hasSeed ? sessionSeed : (uint64_t) time(NULL));
+    InitJobs(jobThreads);
+    if (isHeadless) {
+        int result = RunHeadless();
+        ShutdownJobs();
+        return result;
+    }
+
+    // Frames are paced by vsync rather than a fixed cap, so high refresh displays get an interpolated frame per refresh
+    SetConfigFlags(FLAG_VSYNC_HINT);
     InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Crazy?");
 
     Start();
 
+    // A replay skips the menus and cutscene and starts straight at its first recorded level
+    if (replayPath != NULL && BeginInputReplay(replayPath)) {
+        isStarted = true;
+        isCutscenePlaying = false;
+    } else if (recordPath != NULL) {
+        BeginInputRecording(recordPath);
+    }
+
     SetWindowState(FLAG_WINDOW_RESIZABLE);
 
+    // The browser drives frames itself and never returns here, so web builds skip the teardown
 #if defined(PLATFORM_WEB)
-    emscripten_set_main_loop(MainLoop, 0, 1);
+    emscripten_set_main_loop(Frame, 0, 1);
 #else
-    SetTargetFPS(TARGET_FPS);
+    while (!WindowShouldClose()) Frame();
 #endif
 
-    MainLoop();
+    Shutdown();
     CloseWindow();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include "memory.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__linux__)
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#endif
+
+static HeapStats stats;
+
+void* TrackedMalloc(size_t size) {
+    void* memory = malloc(size);
+    stats.heapCalls++;
+    if (memory != NULL) stats.liveAllocations++;
+    return memory;
+}
+
+void* TrackedCalloc(size_t count, size_t size) {
+    void* memory = calloc(count, size);
+    stats.heapCalls++;
+    if (memory != NULL) stats.liveAllocations++;
+    return memory;
+}
+
+void* TrackedRealloc(void* memory, size_t size) {
+    void* moved = realloc(memory, size);
+    stats.heapCalls++;
+    if (memory == NULL && moved != NULL) stats.liveAllocations++;
+    return moved;
+}
+
+void TrackedFree(void* memory) {
+    if (memory == NULL) return;
+    free(memory);
+    stats.heapCalls++;
+    stats.liveAllocations--;
+}
+
+HeapStats GetHeapStats(void) {
+    return stats;
+}
+
+size_t GetResidentBytes(void) {
+#if defined(__linux__)
+    FILE* file = fopen("/proc/self/statm", "r");
+    if (file == NULL) return 0;
+    unsigned long totalPages = 0, residentPages = 0;
+    int read = fscanf(file, "%lu %lu", &totalPages, &residentPages);
+    fclose(file);
+    return read == 2 ? residentPages * (size_t) sysconf(_SC_PAGESIZE) : 0;
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) != KERN_SUCCESS) return 0;
+    return info.resident_size;
+#else
+    return 0;
+#endif
+}
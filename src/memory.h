@@ -0,0 +1,23 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <stddef.h>
+
+// Every heap allocation the game makes itself goes through these, so leaks and steady-state heap traffic
+// show up in the counters. Memory allocated by raylib or libc is only visible in the resident size.
+void* TrackedMalloc(size_t size);
+void* TrackedCalloc(size_t count, size_t size);
+void* TrackedRealloc(void* memory, size_t size);
+void TrackedFree(void* memory);
+
+typedef struct {
+    long liveAllocations;
+    long heapCalls;
+} HeapStats;
+
+HeapStats GetHeapStats(void);
+
+// Resident set size of the process in bytes, or 0 where the platform does not report it
+size_t GetResidentBytes(void);
+
+#endif
@@ -0,0 +1,92 @@
+#include "overlay.h"
+#include "sprites.h"
+
+#if defined(PLATFORM_WEB)
+#define GLSL_VERSION 100
+#else
+#define GLSL_VERSION 330
+#endif
+
+typedef enum {
+    UNIFORM_SPOTLIGHT_TEXTURE,
+    UNIFORM_TEETH_TEXTURE,
+    UNIFORM_SCREEN_SIZE,
+    UNIFORM_LIGHT_POSITION,
+    UNIFORM_LIGHT_SIZE,
+    UNIFORM_LIGHT_ROTATION,
+    UNIFORM_DARKNESS,
+    UNIFORM_FLICKER,
+    UNIFORM_FLASH,
+    UNIFORM_RED_INTENSITY,
+    UNIFORM_TEETH_TOP,
+    UNIFORM_TEETH_BOTTOM,
+    UNIFORM_COUNT
+} OverlayUniform;
+
+static const char* uniformNames[UNIFORM_COUNT] = {
+    "spotlightTexture", "teethTexture", "screenSize", "lightPosition", "lightSize", "lightRotation",
+    "darkness", "flicker", "flash", "redIntensity", "teethTop", "teethBottom"
+};
+
+static Shader shader;
+static int uniforms[UNIFORM_COUNT];
+static Texture2D spotlightTexture;
+static Texture2D redFlashTexture;
+static Texture2D teethTexture;
+static Vector2 screenSize;
+static float spotlightScale = 1.0f;
+
+void LoadOverlay(const char* directory, int screenWidth, int screenHeight, AssetStage stage) {
+    shader = LoadShader(0, TextFormat("%s/shaders/overlay_%i.fs", directory, GLSL_VERSION));
+    for (int i = 0; i < UNIFORM_COUNT; i++) {
+        uniforms[i] = GetShaderLocation(shader, uniformNames[i]);
+    }
+
+    spotlightScale = QueueBakedTexture(&spotlightTexture, directory, "spotlight.png", stage);
+    QueueBakedTexture(&redFlashTexture, directory, "red_flash.png", stage);
+    QueueTexture(&teethTexture, TextFormat("%s/teeth.png", directory), stage);
+
+    screenSize = (Vector2) { screenWidth, screenHeight };
+    SetShaderValue(shader, uniforms[UNIFORM_SCREEN_SIZE], &screenSize, SHADER_UNIFORM_VEC2);
+}
+
+void UnloadOverlay(void) {
+    UnloadShader(shader);
+    UnloadTexture(spotlightTexture);
+    UnloadTexture(redFlashTexture);
+    UnloadTexture(teethTexture);
+}
+
+void DrawOverlay(const OverlayParams* params) {
+    float lightRotation = params->lightRotation * DEG2RAD;
+    Vector2 lightSize = { spotlightTexture.width / spotlightScale, spotlightTexture.height / spotlightScale };
+
+    // The teeth quads are screen-sized and centred on the texture's own size, the bottom one rotated 180 degrees
+    Vector2 teethOrigin = { teethTexture.width * 0.5f, teethTexture.height * 0.5f };
+    Vector2 teethTop = {
+        screenSize.x * 0.5f - teethOrigin.x,
+        params->teethOffset - params->teethMaxOffset - teethOrigin.y
+    };
+    Vector2 teethBottom = {
+        screenSize.x * 0.5f + teethOrigin.x,
+        screenSize.y - params->teethOffset + params->teethMaxOffset + teethOrigin.y
+    };
+
+    BeginShaderMode(shader);
+    SetShaderValue(shader, uniforms[UNIFORM_LIGHT_POSITION], &params->lightPosition, SHADER_UNIFORM_VEC2);
+    SetShaderValue(shader, uniforms[UNIFORM_LIGHT_SIZE], &lightSize, SHADER_UNIFORM_VEC2);
+    SetShaderValue(shader, uniforms[UNIFORM_LIGHT_ROTATION], &lightRotation, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(shader, uniforms[UNIFORM_DARKNESS], &params->darkness, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(shader, uniforms[UNIFORM_FLICKER], &params->flicker, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(shader, uniforms[UNIFORM_FLASH], &params->flash, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(shader, uniforms[UNIFORM_RED_INTENSITY], &params->redIntensity, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(shader, uniforms[UNIFORM_TEETH_TOP], &teethTop, SHADER_UNIFORM_VEC2);
+    SetShaderValue(shader, uniforms[UNIFORM_TEETH_BOTTOM], &teethBottom, SHADER_UNIFORM_VEC2);
+    // Samplers only stay bound for the draw that follows, so they are set inside the shader block
+    SetShaderValueTexture(shader, uniforms[UNIFORM_SPOTLIGHT_TEXTURE], spotlightTexture);
+    SetShaderValueTexture(shader, uniforms[UNIFORM_TEETH_TEXTURE], teethTexture);
+
+    DrawTexturePro(redFlashTexture, (Rectangle) { 0, 0, redFlashTexture.width, redFlashTexture.height },
+                   (Rectangle) { 0, 0, screenSize.x, screenSize.y }, (Vector2) { 0, 0 }, 0, WHITE);
+    EndShaderMode();
+}
@@ -0,0 +1,26 @@
+#ifndef OVERLAY_H
+#define OVERLAY_H
+
+#include "raylib.h"
+#include "assets.h"
+
+// Inputs of the full-screen overlay pass. Intensities are 0..1 alphas; rotation is in degrees.
+typedef struct {
+    Vector2 lightPosition;
+    float lightRotation;
+    float darkness;
+    float flicker;
+    float flash;
+    float redIntensity;
+    float teethOffset;
+    float teethMaxOffset;
+} OverlayParams;
+
+// Loads the shader right away and queues the textures for the given stage
+void LoadOverlay(const char* directory, int screenWidth, int screenHeight, AssetStage stage);
+void UnloadOverlay(void);
+
+// Draws the spotlight, darkness, flicker, explosion flash, red flash and teeth as a single quad
+void DrawOverlay(const OverlayParams* params);
+
+#endif
@@ -0,0 +1,170 @@
+#include "particles.h"
+
+#include <math.h>
+
+#define BURST_SMOKE_SIZE { 50.0f, 0.0f, 0.0f, 0.0f, 0.0f }
+#define NO_SPIN { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f }
+
+const EmitterDef EMITTERS[EMITTER_COUNT] = {
+    [EMITTER_POOF_SMOKE] = {
+        .capacity = 160, .burstCount = 10, .lifetime = 1.0f,
+        .jitterX = 10, .jitterY = 10, .jitterRate = 60.0f,
+        .layer = DRAW_LAYER_PARTICLES, .size = BURST_SMOKE_SIZE, .rotation = NO_SPIN,
+        .color = { 255, 255, 255, 255 }, .alphaStart = 255.0f, .alphaEnd = 0.0f
+    },
+    [EMITTER_POOF] = {
+        .capacity = 16, .burstCount = 1, .lifetime = 1.0f,
+        .layer = DRAW_LAYER_PARTICLE_SPRITES, .isSprite = true, .sprite = SPRITE_POOF,
+        .size = { 150.0f, 150.0f, 150.0f, 6.0f, 0.0f }, .rotation = { -30.0f, -30.0f, 30.0f, 5.0f, 0.0f },
+        .color = { 255, 255, 255, 255 }, .alphaStart = 512.0f, .alphaEnd = 0.0f
+    },
+    [EMITTER_BLOOD] = {
+        .capacity = 160, .burstCount = 10, .lifetime = 1.0f,
+        .jitterX = 10, .jitterY = 10, .jitterRate = 60.0f,
+        .layer = DRAW_LAYER_PARTICLES, .size = BURST_SMOKE_SIZE, .rotation = NO_SPIN,
+        .color = { 180, 0, 0, 255 }, .alphaStart = 255.0f, .alphaEnd = 0.0f
+    },
+    [EMITTER_NOM] = {
+        .capacity = 16, .burstCount = 1, .lifetime = 1.0f,
+        .layer = DRAW_LAYER_PARTICLE_SPRITES, .isSprite = true, .sprite = SPRITE_NOM,
+        .size = { 100.0f, 100.0f, 100.0f, 6.0f, 0.0f }, .rotation = { -10.0f, -10.0f, 30.0f, 5.0f, 0.0f },
+        .color = { 255, 0, 0, 255 }, .alphaStart = 512.0f, .alphaEnd = 0.0f
+    },
+    // cos(1 - age) * 400, written as a phase-shifted sine
+    [EMITTER_EXPLOSION] = {
+        .capacity = 8, .burstCount = 1, .lifetime = 1.0f,
+        .layer = DRAW_LAYER_EXPLOSION, .isSprite = true, .sprite = SPRITE_EXPLOSION,
+        .size = { 0.0f, 0.0f, 400.0f, 1.0f, PI * 0.5f - 1.0f }, .rotation = { 0.0f, 0.0f, 30.0f, 30.0f, 0.0f },
+        .color = { 255, 255, 255, 255 }, .alphaStart = 255.0f, .alphaEnd = 0.0f
+    },
+    [EMITTER_ELECTRICITY] = {
+        .capacity = 10, .burstCount = 10, .lifetime = 0.0f,
+        .spreadX = 50, .jitterY = 50, .jitterRate = 10.0f, .jitterLimit = 50.0f,
+        .layer = DRAW_LAYER_POWER_SPARKS, .isSprite = true, .isScaled = true, .sprite = SPRITE_ELECTRICITY,
+        .size = { 0.25f, 0.25f, 0.0f, 0.0f, 0.0f }, .rotation = NO_SPIN,
+        .color = { 255, 255, 255, 255 }, .alphaStart = 255.0f, .alphaEnd = 255.0f
+    },
+};
+
+typedef struct {
+    float* positionX;
+    float* positionY;
+    float* originX;
+    float* originY;
+    float* age;
+    int head;
+    int count;
+} ParticlePool;
+
+static ParticlePool pools[EMITTER_COUNT];
+static RandomStream* rng = NULL;
+
+static float evaluateCurve(const ParticleCurve* curve, float age, float t) {
+    float value = curve->start + (curve->end - curve->start) * t;
+    if (curve->pulse != 0.0f) value += curve->pulse * sinf(curve->frequency * age + curve->phase);
+    return value;
+}
+
+static float jitter(int amplitude, float step) {
+    return amplitude > 0 ? RandomRange(rng, -amplitude, amplitude) * step : 0.0f;
+}
+
+void InitParticles(Arena* arena, RandomStream* random) {
+    rng = random;
+    for (int e = 0; e < EMITTER_COUNT; e++) {
+        int capacity = EMITTERS[e].capacity;
+        pools[e] = (ParticlePool) {
+            .positionX = ARENA_ARRAY(arena, float, capacity),
+            .positionY = ARENA_ARRAY(arena, float, capacity),
+            .originX = ARENA_ARRAY(arena, float, capacity),
+            .originY = ARENA_ARRAY(arena, float, capacity),
+            .age = ARENA_ARRAY(arena, float, capacity)
+        };
+    }
+}
+
+void EmitParticles(EmitterId emitter, Vector2 position) {
+    const EmitterDef* def = &EMITTERS[emitter];
+    ParticlePool* pool = &pools[emitter];
+    for (int k = 0; k < def->burstCount; k++) {
+        int i = pool->head;
+        pool->positionX[i] = position.x + jitter(def->spreadX, 1.0f);
+        pool->positionY[i] = position.y + jitter(def->spreadY, 1.0f);
+        pool->originX[i] = position.x;
+        pool->originY[i] = position.y;
+        pool->age[i] = 0.0f;
+
+        pool->head = pool->head + 1 == def->capacity ? 0 : pool->head + 1;
+        if (pool->count < def->capacity) pool->count++;
+    }
+}
+
+void ClearParticles(EmitterId emitter) {
+    pools[emitter].count = 0;
+}
+
+int GetParticleCount(void) {
+    int count = 0;
+    for (int e = 0; e < EMITTER_COUNT; e++) count += pools[e].count;
+    return count;
+}
+
+void UpdateParticles(float deltaTime) {
+    for (int e = 0; e < EMITTER_COUNT; e++) {
+        const EmitterDef* def = &EMITTERS[e];
+        ParticlePool* pool = &pools[e];
+        if (pool->count == 0) continue;
+
+        float step = deltaTime * def->jitterRate;
+        int tail = pool->head - pool->count;
+        if (tail < 0) tail += def->capacity;
+
+        for (int k = 0, i = tail; k < pool->count; k++, i = i + 1 == def->capacity ? 0 : i + 1) {
+            pool->age[i] += deltaTime;
+            pool->positionX[i] += jitter(def->jitterX, step);
+            pool->positionY[i] += jitter(def->jitterY, step);
+            if (def->jitterLimit > 0.0f) {
+                pool->positionX[i] = fminf(fmaxf(pool->positionX[i], pool->originX[i] - def->jitterLimit), pool->originX[i] + def->jitterLimit);
+                pool->positionY[i] = fminf(fmaxf(pool->positionY[i], pool->originY[i] - def->jitterLimit), pool->originY[i] + def->jitterLimit);
+            }
+        }
+
+        // Particles are emitted in age order, so the expired ones are always at the tail
+        while (def->lifetime > 0.0f && pool->count > 0 && pool->age[tail] >= def->lifetime) {
+            tail = tail + 1 == def->capacity ? 0 : tail + 1;
+            pool->count--;
+        }
+    }
+}
+
+void DrawParticles(void) {
+    for (int e = 0; e < EMITTER_COUNT; e++) {
+        const EmitterDef* def = &EMITTERS[e];
+        const ParticlePool* pool = &pools[e];
+        if (pool->count == 0) continue;
+
+        Vector2 spriteSize = def->isSprite ? GetSpriteSize(def->sprite) : (Vector2) { 0.0f, 0.0f };
+        Rectangle source = { 0.0f, 0.0f, spriteSize.x, spriteSize.y };
+        int tail = pool->head - pool->count;
+        if (tail < 0) tail += def->capacity;
+
+        for (int k = 0, i = tail; k < pool->count; k++, i = i + 1 == def->capacity ? 0 : i + 1) {
+            float age = pool->age[i];
+            float t = def->lifetime > 0.0f ? age / def->lifetime : 0.0f;
+            float size = evaluateCurve(&def->size, age, t);
+            Color tint = def->color;
+            tint.a = (unsigned char) fminf(fmaxf(def->alphaStart + (def->alphaEnd - def->alphaStart) * t, 0.0f), 255.0f);
+
+            if (!def->isSprite) {
+                PushCircle(def->layer, (Vector2) { pool->positionX[i], pool->positionY[i] }, size, tint);
+                continue;
+            }
+
+            float width = def->isScaled ? spriteSize.x * size : size;
+            float height = def->isScaled ? spriteSize.y * size : size;
+            PushSprite(def->layer, def->sprite, source,
+                       (Rectangle) { pool->positionX[i], pool->positionY[i], width, height },
+                       (Vector2) { width * 0.5f, height * 0.5f }, evaluateCurve(&def->rotation, age, t), tint);
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include <stdbool.h>
+#include "raylib.h"
+#include "arena.h"
+#include "drawlist.h"
+#include "random.h"
+#include "sprites.h"
+
+typedef enum {
+    EMITTER_POOF_SMOKE,
+    EMITTER_POOF,
+    EMITTER_BLOOD,
+    EMITTER_NOM,
+    EMITTER_EXPLOSION,
+    EMITTER_ELECTRICITY,
+    EMITTER_COUNT
+} EmitterId;
+
+// Size and spin follow start + (end - start) * age / lifetime + pulse * sin(frequency * age + phase), age in seconds
+typedef struct {
+    float start;
+    float end;
+    float pulse;
+    float frequency;
+    float phase;
+} ParticleCurve;
+
+// Every particle of an emitter lives equally long, so each pool is a ring that expires from its tail.
+// Emitting into a full ring overwrites its oldest particles.
+typedef struct {
+    int capacity;
+    int burstCount;
+    float lifetime;
+    int spreadX;
+    int spreadY;
+    int jitterX;
+    int jitterY;
+    float jitterRate;
+    float jitterLimit;
+
+    DrawLayer layer;
+    bool isSprite;
+    bool isScaled;
+    SpriteId sprite;
+    ParticleCurve size;
+    ParticleCurve rotation;
+    Color color;
+    float alphaStart;
+    float alphaEnd;
+} EmitterDef;
+
+// Lifetime 0 keeps particles until ClearParticles. Size is a circle radius, a sprite's width and height,
+// or a multiple of the sprite size when isScaled.
+extern const EmitterDef EMITTERS[EMITTER_COUNT];
+
+// Carves every pool out of the arena, so resetting the arena and calling this again drops all particles
+void InitParticles(Arena* arena, RandomStream* random);
+void EmitParticles(EmitterId emitter, Vector2 position);
+void ClearParticles(EmitterId emitter);
+int GetParticleCount(void);
+
+void UpdateParticles(float deltaTime);
+void DrawParticles(void);
+
+#endif
@@ -0,0 +1,110 @@
+#include "profiler.h"
+
+#if defined(CRAZY_PROFILER)
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "raylib.h"
+
+#define PROFILE_WINDOW 240
+
+#define PROFILE_NAME(id, name) name,
+static const char* stageNames[PROFILE_STAGE_COUNT] = { PROFILE_STAGE_LIST(PROFILE_NAME) };
+static const char* counterNames[PROFILE_COUNTER_COUNT] = { PROFILE_COUNTER_LIST(PROFILE_NAME) };
+#undef PROFILE_NAME
+
+static double stageStart[PROFILE_STAGE_COUNT];
+static double stageTotal[PROFILE_STAGE_COUNT];
+static float samples[PROFILE_STAGE_COUNT][PROFILE_WINDOW];
+static int counters[PROFILE_COUNTER_COUNT];
+static int sampleCount = 0;
+static int sampleCursor = 0;
+static bool isOverlayVisible = false;
+
+static double now(void) {
+#if defined(CLOCK_MONOTONIC)
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+#else
+    struct timespec time;
+    timespec_get(&time, TIME_UTC);
+#endif
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+void ProfileBegin(ProfileStage stage) {
+    stageStart[stage] = now();
+}
+
+void ProfileEnd(ProfileStage stage) {
+    stageTotal[stage] += now() - stageStart[stage];
+}
+
+void ProfileCount(ProfileCounter counter, int value) {
+    counters[counter] = value;
+}
+
+void ProfileFrame(void) {
+    for (int i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        samples[i][sampleCursor] = (float) (stageTotal[i] * 1000.0);
+        stageTotal[i] = 0.0;
+    }
+    sampleCursor = (sampleCursor + 1) % PROFILE_WINDOW;
+    if (sampleCount < PROFILE_WINDOW) sampleCount++;
+}
+
+void ToggleProfilerOverlay(void) {
+    isOverlayVisible = !isOverlayVisible;
+}
+
+static int compareFloats(const void* a, const void* b) {
+    float left = *(const float*) a;
+    float right = *(const float*) b;
+    return (left > right) - (left < right);
+}
+
+void DrawProfilerOverlay(void) {
+    if (!isOverlayVisible || sampleCount == 0) return;
+
+    const int fontSize = 10;
+    const int lineHeight = 12;
+    const int columnWidth = 60;
+    const int width = 110 + columnWidth * 3;
+    const int x = GetScreenWidth() - width - 10;
+    int y = 60;
+
+    // The default font is proportional, so every column is drawn separately
+    DrawRectangle(x - 5, y - 5, width + 10, (PROFILE_STAGE_COUNT + PROFILE_COUNTER_COUNT + 2) * lineHeight + 10, (Color) { 0, 0, 0, 200 });
+    DrawText("ms", x, y, fontSize, YELLOW);
+    DrawText("min", x + 110, y, fontSize, YELLOW);
+    DrawText("avg", x + 110 + columnWidth, y, fontSize, YELLOW);
+    DrawText("p99", x + 110 + columnWidth * 2, y, fontSize, YELLOW);
+    y += lineHeight;
+
+    float sorted[PROFILE_WINDOW];
+    for (int i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        memcpy(sorted, samples[i], sampleCount * sizeof(float));
+        qsort(sorted, sampleCount, sizeof(float), compareFloats);
+
+        double sum = 0.0;
+        for (int s = 0; s < sampleCount; s++) sum += sorted[s];
+        float p99 = sorted[(sampleCount - 1) * 99 / 100];
+
+        DrawText(stageNames[i], x, y, fontSize, WHITE);
+        DrawText(TextFormat("%.3f", sorted[0]), x + 110, y, fontSize, WHITE);
+        DrawText(TextFormat("%.3f", sum / sampleCount), x + 110 + columnWidth, y, fontSize, WHITE);
+        DrawText(TextFormat("%.3f", p99), x + 110 + columnWidth * 2, y, fontSize, WHITE);
+        y += lineHeight;
+    }
+
+    y += lineHeight;
+    for (int i = 0; i < PROFILE_COUNTER_COUNT; i++) {
+        DrawText(counterNames[i], x, y, fontSize, WHITE);
+        DrawText(TextFormat("%i", counters[i]), x + 110, y, fontSize, WHITE);
+        y += lineHeight;
+    }
+}
+
+#endif
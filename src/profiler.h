@@ -0,0 +1,81 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+// Per-stage frame timers with an on-screen overlay. Only built when CRAZY_PROFILER is defined,
+// which CMake does for every configuration except Release and MinSizeRel.
+
+#define PROFILE_STAGE_LIST(X) \
+    X(PROFILE_GRID, "Grid") \
+    X(PROFILE_STATS, "Stats") \
+    X(PROFILE_CHEESE, "Cheese") \
+    X(PROFILE_SPAWNERS, "Spawners") \
+    X(PROFILE_RATS, "Rats") \
+    X(PROFILE_PLAYER, "Player") \
+    X(PROFILE_FAT_RAT, "Fat rat") \
+    X(PROFILE_MOUSE, "Mouse logic") \
+    X(PROFILE_LEVEL, "Level") \
+    X(PROFILE_SCREEN_EFFECTS, "Screen effects") \
+    X(PROFILE_DRAW_WORLD, "Draw world") \
+    X(PROFILE_DRAW_SUBMIT, "Draw submit") \
+    X(PROFILE_DRAW_UI, "Draw UI") \
+    X(PROFILE_AUDIO, "Audio") \
+    X(PROFILE_ASSETS, "Asset uploads") \
+    X(PROFILE_END_DRAWING, "EndDrawing") \
+    X(PROFILE_FRAME, "Frame")
+
+#define PROFILE_COUNTER_LIST(X) \
+    X(PROFILE_STEPS, "Steps") \
+    X(PROFILE_DRAW_COMMANDS, "Draw commands") \
+    X(PROFILE_DRAW_CULLED, "Culled") \
+    X(PROFILE_DRAW_BATCHES, "Texture batches") \
+    X(PROFILE_RAT_COUNT, "Rats") \
+    X(PROFILE_EXPLOSIVE_RAT_COUNT, "Explosive rats") \
+    X(PROFILE_PARTICLE_COUNT, "Particles") \
+    X(PROFILE_FRAME_ARENA_KB, "Frame arena KB") \
+    X(PROFILE_LEVEL_ARENA_KB, "Level arena KB")
+
+#define PROFILE_ENUM(id, name) id,
+typedef enum {
+    PROFILE_STAGE_LIST(PROFILE_ENUM)
+    PROFILE_STAGE_COUNT
+} ProfileStage;
+
+typedef enum {
+    PROFILE_COUNTER_LIST(PROFILE_ENUM)
+    PROFILE_COUNTER_COUNT
+} ProfileCounter;
+#undef PROFILE_ENUM
+
+#if defined(CRAZY_PROFILER)
+
+void ProfileBegin(ProfileStage stage);
+void ProfileEnd(ProfileStage stage);
+void ProfileCount(ProfileCounter counter, int value);
+
+// Closes the frame: stage times accumulated since the last call become one sample in the rolling window
+void ProfileFrame(void);
+void ToggleProfilerOverlay(void);
+void DrawProfilerOverlay(void);
+
+// Times a statement, accumulating into the stage when it runs several times in a frame
+#define PROFILE(stage, statement) do { ProfileBegin(stage); statement; ProfileEnd(stage); } while (0)
+#define PROFILE_BEGIN(stage) ProfileBegin(stage)
+#define PROFILE_END(stage) ProfileEnd(stage)
+#define PROFILE_COUNT(counter, value) ProfileCount(counter, value)
+#define PROFILE_FRAME() ProfileFrame()
+#define PROFILE_TOGGLE_OVERLAY() ToggleProfilerOverlay()
+#define PROFILE_DRAW_OVERLAY() DrawProfilerOverlay()
+
+#else
+
+#define PROFILE(stage, statement) do { statement; } while (0)
+#define PROFILE_BEGIN(stage) ((void) 0)
+#define PROFILE_END(stage) ((void) 0)
+#define PROFILE_COUNT(counter, value) ((void) sizeof(value))
+#define PROFILE_FRAME() ((void) 0)
+#define PROFILE_TOGGLE_OVERLAY() ((void) 0)
+#define PROFILE_DRAW_OVERLAY() ((void) 0)
+
+#endif
+
+#endif
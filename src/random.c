@@ -0,0 +1,27 @@
+#include "random.h"
+
+void SeedRandom(RandomStream* rng, uint64_t seed, uint64_t stream) {
+    rng->state = 0;
+    rng->increment = (stream << 1) | 1;
+    NextRandom(rng);
+    rng->state += seed;
+    NextRandom(rng);
+}
+
+uint32_t NextRandom(RandomStream* rng) {
+    uint64_t state = rng->state;
+    rng->state = state * 6364136223846793005ULL + rng->increment;
+
+    uint32_t shifted = (uint32_t) (((state >> 18) ^ state) >> 27);
+    uint32_t rotation = (uint32_t) (state >> 59);
+    return (shifted >> rotation) | (shifted << ((-rotation) & 31));
+}
+
+int RandomInt(RandomStream* rng, int bound) {
+    // Multiply-shift range reduction: no division, and the bias is negligible for the small bounds used here
+    return (int) (((uint64_t) NextRandom(rng) * (uint32_t) bound) >> 32);
+}
+
+int RandomRange(RandomStream* rng, int min, int max) {
+    return min + RandomInt(rng, max - min);
+}
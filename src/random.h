@@ -0,0 +1,20 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <stdint.h>
+
+// PCG32: 64-bit state, 32-bit output. Streams with different ids never overlap for the same seed.
+typedef struct {
+    uint64_t state;
+    uint64_t increment;
+} RandomStream;
+
+void SeedRandom(RandomStream* rng, uint64_t seed, uint64_t stream);
+uint32_t NextRandom(RandomStream* rng);
+
+// Uniform in [0, bound)
+int RandomInt(RandomStream* rng, int bound);
+// Uniform in [min, max)
+int RandomRange(RandomStream* rng, int min, int max);
+
+#endif
@@ -0,0 +1,170 @@
+#include "ratstore.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "memory.h"
+
+static void* growArray(void* array, int capacity, size_t elementSize) {
+    void* grown = TrackedRealloc(array, capacity * elementSize);
+    if (grown == NULL) {
+        abort();
+    }
+    return grown;
+}
+
+static void reserve(RatStore* store, int capacity) {
+    if (capacity <= store->capacity) return;
+
+    int newCapacity = store->capacity > 0 ? store->capacity : 16;
+    while (newCapacity < capacity) {
+        newCapacity *= 2;
+    }
+
+    store->positionX = growArray(store->positionX, newCapacity, sizeof(float));
+    store->positionY = growArray(store->positionY, newCapacity, sizeof(float));
+    store->previousX = growArray(store->previousX, newCapacity, sizeof(float));
+    store->previousY = growArray(store->previousY, newCapacity, sizeof(float));
+    store->velocityX = growArray(store->velocityX, newCapacity, sizeof(float));
+    store->velocityY = growArray(store->velocityY, newCapacity, sizeof(float));
+    store->rotation = growArray(store->rotation, newCapacity, sizeof(float));
+    store->scale = growArray(store->scale, newCapacity, sizeof(float));
+    store->type = growArray(store->type, newCapacity, sizeof(int));
+    store->flags = growArray(store->flags, newCapacity, sizeof(uint8_t));
+    store->throwTimer = growArray(store->throwTimer, newCapacity, sizeof(float));
+    store->throwX = growArray(store->throwX, newCapacity, sizeof(float));
+    store->throwY = growArray(store->throwY, newCapacity, sizeof(float));
+
+    store->denseToSlot = growArray(store->denseToSlot, newCapacity, sizeof(uint32_t));
+    store->slotToDense = growArray(store->slotToDense, newCapacity, sizeof(uint32_t));
+    store->slotGeneration = growArray(store->slotGeneration, newCapacity, sizeof(uint32_t));
+    store->freeSlots = growArray(store->freeSlots, newCapacity, sizeof(uint32_t));
+
+    store->capacity = newCapacity;
+}
+
+void InitRatStore(RatStore* store, int capacity) {
+    memset(store, 0, sizeof(RatStore));
+    reserve(store, capacity);
+}
+
+void UnloadRatStore(RatStore* store) {
+    TrackedFree(store->positionX);
+    TrackedFree(store->positionY);
+    TrackedFree(store->previousX);
+    TrackedFree(store->previousY);
+    TrackedFree(store->velocityX);
+    TrackedFree(store->velocityY);
+    TrackedFree(store->rotation);
+    TrackedFree(store->scale);
+    TrackedFree(store->type);
+    TrackedFree(store->flags);
+    TrackedFree(store->throwTimer);
+    TrackedFree(store->throwX);
+    TrackedFree(store->throwY);
+    TrackedFree(store->denseToSlot);
+    TrackedFree(store->slotToDense);
+    TrackedFree(store->slotGeneration);
+    TrackedFree(store->freeSlots);
+    memset(store, 0, sizeof(RatStore));
+}
+
+void ClearRatStore(RatStore* store) {
+    while (store->count > 0) {
+        DespawnRatAt(store, store->count - 1);
+    }
+}
+
+RatHandle SpawnRat(RatStore* store, Vector2 position, int type) {
+    reserve(store, store->count + 1);
+
+    uint32_t slot;
+    if (store->freeSlotCount > 0) {
+        slot = store->freeSlots[--store->freeSlotCount];
+    } else {
+        slot = store->slotCount++;
+        store->slotGeneration[slot] = 1;
+    }
+
+    int index = store->count++;
+    store->denseToSlot[index] = slot;
+    store->slotToDense[slot] = index;
+
+    store->positionX[index] = position.x;
+    store->positionY[index] = position.y;
+    store->previousX[index] = position.x;
+    store->previousY[index] = position.y;
+    store->velocityX[index] = 0.0f;
+    store->velocityY[index] = 0.0f;
+    store->rotation[index] = 0.0f;
+    store->scale[index] = 0.5f;
+    store->type[index] = type;
+    store->flags[index] = 0;
+    store->throwTimer[index] = 0.0f;
+    store->throwX[index] = 0.0f;
+    store->throwY[index] = 0.0f;
+
+    return (RatHandle) { slot, store->slotGeneration[slot] };
+}
+
+void DespawnRatAt(RatStore* store, int index) {
+    int last = store->count - 1;
+    uint32_t slot = store->denseToSlot[index];
+
+    if (index != last) {
+        store->positionX[index] = store->positionX[last];
+        store->positionY[index] = store->positionY[last];
+        store->previousX[index] = store->previousX[last];
+        store->previousY[index] = store->previousY[last];
+        store->velocityX[index] = store->velocityX[last];
+        store->velocityY[index] = store->velocityY[last];
+        store->rotation[index] = store->rotation[last];
+        store->scale[index] = store->scale[last];
+        store->type[index] = store->type[last];
+        store->flags[index] = store->flags[last];
+        store->throwTimer[index] = store->throwTimer[last];
+        store->throwX[index] = store->throwX[last];
+        store->throwY[index] = store->throwY[last];
+
+        uint32_t movedSlot = store->denseToSlot[last];
+        store->denseToSlot[index] = movedSlot;
+        store->slotToDense[movedSlot] = index;
+    }
+
+    store->count--;
+    store->slotGeneration[slot]++;
+    store->freeSlots[store->freeSlotCount++] = slot;
+}
+
+void DespawnRat(RatStore* store, RatHandle handle) {
+    int index = GetRatIndex(store, handle);
+    if (index < 0) return;
+    DespawnRatAt(store, index);
+}
+
+bool IsRatAlive(const RatStore* store, RatHandle handle) {
+    return GetRatIndex(store, handle) >= 0;
+}
+
+int GetRatIndex(const RatStore* store, RatHandle handle) {
+    if (handle.generation == 0 || handle.slot >= (uint32_t) store->slotCount) return -1;
+    if (store->slotGeneration[handle.slot] != handle.generation) return -1;
+    return store->slotToDense[handle.slot];
+}
+
+RatHandle GetRatHandle(const RatStore* store, int index) {
+    uint32_t slot = store->denseToSlot[index];
+    return (RatHandle) { slot, store->slotGeneration[slot] };
+}
+
+bool IsSameRat(RatHandle a, RatHandle b) {
+    return a.slot == b.slot && a.generation == b.generation;
+}
+
+Vector2 GetRatPosition(const RatStore* store, int index) {
+    return (Vector2) { store->positionX[index], store->positionY[index] };
+}
+
+void SetRatPosition(RatStore* store, int index, Vector2 position) {
+    store->positionX[index] = position.x;
+    store->positionY[index] = position.y;
+}
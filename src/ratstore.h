@@ -0,0 +1,62 @@
+#ifndef RATSTORE_H
+#define RATSTORE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "raylib.h"
+
+#define RAT_ENRAGED 1
+#define RAT_HELD 2
+
+// Refers to a rat across despawns: a handle whose slot has been reused no longer resolves
+typedef struct {
+    uint32_t slot;
+    uint32_t generation;
+} RatHandle;
+
+#define RAT_HANDLE_NONE (RatHandle) { 0, 0 }
+
+// Rats are stored densely, one array per field, so update loops run linearly over [0, count)
+typedef struct {
+    int count;
+    int capacity;
+
+    float* positionX;
+    float* positionY;
+    float* previousX;
+    float* previousY;
+    float* velocityX;
+    float* velocityY;
+    float* rotation;
+    float* scale;
+    int* type;
+    uint8_t* flags;
+    float* throwTimer;
+    float* throwX;
+    float* throwY;
+
+    uint32_t* denseToSlot;
+    uint32_t* slotToDense;
+    uint32_t* slotGeneration;
+    uint32_t* freeSlots;
+    int freeSlotCount;
+    int slotCount;
+} RatStore;
+
+void InitRatStore(RatStore* store, int capacity);
+void UnloadRatStore(RatStore* store);
+void ClearRatStore(RatStore* store);
+
+RatHandle SpawnRat(RatStore* store, Vector2 position, int type);
+void DespawnRat(RatStore* store, RatHandle handle);
+void DespawnRatAt(RatStore* store, int index);
+
+bool IsRatAlive(const RatStore* store, RatHandle handle);
+int GetRatIndex(const RatStore* store, RatHandle handle);
+RatHandle GetRatHandle(const RatStore* store, int index);
+bool IsSameRat(RatHandle a, RatHandle b);
+
+Vector2 GetRatPosition(const RatStore* store, int index);
+void SetRatPosition(RatStore* store, int index, Vector2 position);
+
+#endif
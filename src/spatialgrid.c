@@ -0,0 +1,181 @@
+#include "spatialgrid.h"
+
+#include <math.h>
+#include <string.h>
+#include "memory.h"
+
+static int cellColumn(const SpatialGrid* grid, float x) {
+    int column = (int) floorf(x / grid->cellSize);
+    if (column < 0) return 0;
+    if (column >= grid->columns) return grid->columns - 1;
+    return column;
+}
+
+static int cellRow(const SpatialGrid* grid, float y) {
+    int row = (int) floorf(y / grid->cellSize);
+    if (row < 0) return 0;
+    if (row >= grid->rows) return grid->rows - 1;
+    return row;
+}
+
+void InitSpatialGrid(SpatialGrid* grid, float width, float height, float cellSize) {
+    memset(grid, 0, sizeof(SpatialGrid));
+    grid->cellSize = cellSize;
+    grid->columns = (int) ceilf(width / cellSize);
+    grid->rows = (int) ceilf(height / cellSize);
+    grid->cellStart = TrackedCalloc(grid->columns * grid->rows + 1, sizeof(int));
+    grid->cellCursor = TrackedCalloc(grid->columns * grid->rows, sizeof(int));
+}
+
+void UnloadSpatialGrid(SpatialGrid* grid) {
+    TrackedFree(grid->cellStart);
+    TrackedFree(grid->cellCursor);
+    TrackedFree(grid->cellRats);
+    TrackedFree(grid->ratCell);
+    TrackedFree(grid->results);
+    TrackedFree(grid->hitMask);
+    memset(grid, 0, sizeof(SpatialGrid));
+}
+
+void BuildSpatialGrid(SpatialGrid* grid, const RatStore* store) {
+    if (store->count > grid->capacity) {
+        grid->capacity = store->capacity;
+        grid->cellRats = TrackedRealloc(grid->cellRats, sizeof(int) * grid->capacity);
+        grid->ratCell = TrackedRealloc(grid->ratCell, sizeof(int) * grid->capacity);
+        grid->results = TrackedRealloc(grid->results, sizeof(int) * grid->capacity);
+        TrackedFree(grid->hitMask);
+        grid->hitMask = TrackedCalloc((grid->capacity + 63) / 64, sizeof(uint64_t));
+    }
+
+    int cellCount = grid->columns * grid->rows;
+    memset(grid->cellStart, 0, sizeof(int) * (cellCount + 1));
+    grid->maxScale = 0.0f;
+    grid->resultCount = 0;
+
+    // Counting sort keeps each cell's indices ascending
+    for (int i = 0; i < store->count; i++) {
+        int cell = cellRow(grid, store->positionY[i]) * grid->columns + cellColumn(grid, store->positionX[i]);
+        grid->ratCell[i] = cell;
+        grid->cellStart[cell + 1]++;
+        if (store->scale[i] > grid->maxScale) grid->maxScale = store->scale[i];
+    }
+
+    for (int cell = 0; cell < cellCount; cell++) {
+        grid->cellStart[cell + 1] += grid->cellStart[cell];
+    }
+
+    memcpy(grid->cellCursor, grid->cellStart, sizeof(int) * cellCount);
+    for (int i = 0; i < store->count; i++) {
+        grid->cellRats[grid->cellCursor[grid->ratCell[i]]++] = i;
+    }
+}
+
+int QueryGridRadius(SpatialGrid* grid, const RatStore* store, Vector2 center, float radius) {
+    grid->resultCount = 0;
+    if (store->count == 0) return 0;
+    float radiusSquared = radius * radius;
+
+    int minColumn = cellColumn(grid, center.x - radius);
+    int maxColumn = cellColumn(grid, center.x + radius);
+    int minRow = cellRow(grid, center.y - radius);
+    int maxRow = cellRow(grid, center.y + radius);
+
+    for (int row = minRow; row <= maxRow; row++) {
+        for (int column = minColumn; column <= maxColumn; column++) {
+            int cell = row * grid->columns + column;
+            for (int k = grid->cellStart[cell]; k < grid->cellStart[cell + 1]; k++) {
+                int i = grid->cellRats[k];
+                float dx = store->positionX[i] - center.x;
+                float dy = store->positionY[i] - center.y;
+                if (dx * dx + dy * dy < radiusSquared) {
+                    grid->results[grid->resultCount++] = i;
+                }
+            }
+        }
+    }
+
+    return grid->resultCount;
+}
+
+int QueryGridRadiusOrdered(SpatialGrid* grid, const RatStore* store, Vector2 center, float radius) {
+    int count = QueryGridRadius(grid, store, center, radius);
+    if (count < 2) return count;
+
+    // Hits are marked in a bitmap and read back in index order, which costs a pass over the words between the
+    // lowest and highest hit instead of a sort; the mask is left cleared for the next query
+    int lowest = grid->results[0];
+    int highest = grid->results[0];
+    for (int k = 0; k < count; k++) {
+        int i = grid->results[k];
+        grid->hitMask[i / 64] |= (uint64_t) 1 << (i % 64);
+        if (i < lowest) lowest = i;
+        if (i > highest) highest = i;
+    }
+
+    grid->resultCount = 0;
+    for (int word = lowest / 64; word <= highest / 64; word++) {
+        uint64_t bits = grid->hitMask[word];
+        grid->hitMask[word] = 0;
+        for (int bit = 0; bits != 0; bit++, bits >>= 1) {
+            if (bits & 1) {
+                grid->results[grid->resultCount++] = word * 64 + bit;
+            }
+        }
+    }
+    return grid->resultCount;
+}
+
+int QueryGridPoint(SpatialGrid* grid, const RatStore* store, Vector2 point, float scaleFactor) {
+    int candidateCount = QueryGridRadius(grid, store, point, grid->maxScale * scaleFactor);
+
+    grid->resultCount = 0;
+    for (int k = 0; k < candidateCount; k++) {
+        int i = grid->results[k];
+        float radius = store->scale[i] * scaleFactor;
+        float dx = store->positionX[i] - point.x;
+        float dy = store->positionY[i] - point.y;
+        if (dx * dx + dy * dy < radius * radius) {
+            grid->results[grid->resultCount++] = i;
+        }
+    }
+    return grid->resultCount;
+}
+
+int FindNearestRat(const SpatialGrid* grid, const RatStore* store, Vector2 point, float maxDistance) {
+    if (store->count == 0) return -1;
+
+    int centerColumn = cellColumn(grid, point.x);
+    int centerRow = cellRow(grid, point.y);
+    int maxRing = grid->columns > grid->rows ? grid->columns : grid->rows;
+
+    int closest = -1;
+    float closestSquared = maxDistance * maxDistance;
+
+    // Cells in ring k + 1 are at least k cells away, so once the best match is that close no later ring can win
+    for (int ring = 0; ring <= maxRing; ring++) {
+        float ringDistance = (ring - 1) * grid->cellSize;
+        if (ringDistance > 0.0f && ringDistance * ringDistance > closestSquared) break;
+
+        for (int row = centerRow - ring; row <= centerRow + ring; row++) {
+            if (row < 0 || row >= grid->rows) continue;
+            bool isEdgeRow = row == centerRow - ring || row == centerRow + ring;
+            int step = isEdgeRow ? 1 : ring * 2;
+            for (int column = centerColumn - ring; column <= centerColumn + ring; column += step) {
+                if (column < 0 || column >= grid->columns) continue;
+                int cell = row * grid->columns + column;
+                for (int k = grid->cellStart[cell]; k < grid->cellStart[cell + 1]; k++) {
+                    int i = grid->cellRats[k];
+                    float dx = store->positionX[i] - point.x;
+                    float dy = store->positionY[i] - point.y;
+                    float distanceSquared = dx * dx + dy * dy;
+                    if (distanceSquared < closestSquared || (distanceSquared == closestSquared && closest >= 0 && i < closest)) {
+                        closestSquared = distanceSquared;
+                        closest = i;
+                    }
+                }
+            }
+        }
+    }
+
+    return closest;
+}
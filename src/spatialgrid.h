@@ -0,0 +1,39 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include "ratstore.h"
+
+// Uniform grid bucketing rats by cell. Rats outside the arena are kept in the nearest border cell.
+typedef struct {
+    float cellSize;
+    int columns;
+    int rows;
+
+    int* cellStart;
+    int* cellCursor;
+    int* cellRats;
+    int* ratCell;
+    int capacity;
+    float maxScale;
+
+    int* results;
+    int resultCount;
+    uint64_t* hitMask;
+} SpatialGrid;
+
+void InitSpatialGrid(SpatialGrid* grid, float width, float height, float cellSize);
+void UnloadSpatialGrid(SpatialGrid* grid);
+void BuildSpatialGrid(SpatialGrid* grid, const RatStore* store);
+
+// Queries fill grid->results with rat indices in cell order and return how many were found. Callers picking one rat
+// take the lowest index among them, so the choice doesn't depend on the grid layout.
+int QueryGridRadius(SpatialGrid* grid, const RatStore* store, Vector2 center, float radius);
+int QueryGridPoint(SpatialGrid* grid, const RatStore* store, Vector2 point, float scaleFactor);
+
+// Like QueryGridRadius with the indices in ascending order, for callers that despawn what they find from the top down
+int QueryGridRadiusOrdered(SpatialGrid* grid, const RatStore* store, Vector2 center, float radius);
+
+// Index of the closest rat strictly within maxDistance, lowest index on ties, or -1
+int FindNearestRat(const SpatialGrid* grid, const RatStore* store, Vector2 point, float maxDistance);
+
+#endif
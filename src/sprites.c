@@ -0,0 +1,148 @@
+#include "sprites.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "assets.h"
+
+#define SPRITE_FILE(id, file, bakeScale) file,
+static const char* spriteFiles[SPRITE_COUNT] = {
+    SPRITE_LIST(SPRITE_FILE)
+};
+#undef SPRITE_FILE
+
+#define SPRITE_BAKE_SCALE(id, file, bakeScale) bakeScale,
+static const float spriteBakeScales[SPRITE_COUNT] = {
+    SPRITE_LIST(SPRITE_BAKE_SCALE)
+};
+#undef SPRITE_BAKE_SCALE
+
+static Texture2D pages[MAX_ATLAS_PAGES + SPRITE_COUNT];
+static int pageCount = 0;
+static Sprite sprites[SPRITE_COUNT];
+static bool isLoose = false;
+
+static bool queueAtlas(const char* directory, AssetStage stage) {
+    char* table = LoadFileText(TextFormat("%s/baked/%s", directory, ATLAS_TABLE_FILE));
+    if (table == NULL) return false;
+
+    int tablePages = 0;
+    int offset = 0;
+    bool isValid = sscanf(table, "pages %d\n%n", &tablePages, &offset) == 1 && tablePages > 0 && tablePages <= MAX_ATLAS_PAGES;
+
+    for (int i = 0; isValid && i < SPRITE_COUNT; i++) {
+        char name[64];
+        Sprite sprite;
+        int read = 0;
+        isValid = sscanf(table + offset, "%63s %d %f %f %f %f %f %f\n%n", name, &sprite.page,
+                         &sprite.rect.x, &sprite.rect.y, &sprite.rect.width, &sprite.rect.height,
+                         &sprite.width, &sprite.height, &read) == 8
+                  && strcmp(name, spriteFiles[i]) == 0 && sprite.page >= 0 && sprite.page < tablePages;
+        offset += read;
+        sprites[i] = sprite;
+    }
+    UnloadFileText(table);
+
+    if (!isValid) {
+        TraceLog(LOG_WARNING, "SPRITES: Atlas table is out of date, falling back to loose textures");
+        return false;
+    }
+
+    for (int i = 0; i < tablePages; i++) {
+        QueueTextureEx(&pages[i], TextFormat("%s/baked/atlas%i.png", directory, i), stage, TEXTURE_FILTER_TRILINEAR);
+    }
+    pageCount = tablePages;
+    return true;
+}
+
+void QueueSprites(const char* directory, AssetStage stage) {
+    isLoose = !queueAtlas(directory, stage);
+    if (!isLoose) return;
+
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+        QueueTextureEx(&pages[pageCount], TextFormat("%s/%s", directory, spriteFiles[i]), stage, TEXTURE_FILTER_TRILINEAR);
+        sprites[i] = (Sprite) { .page = pageCount };
+        pageCount++;
+    }
+}
+
+float QueueBakedTexture(Texture2D* texture, const char* directory, const char* file, AssetStage stage) {
+#define BAKED_TEXTURE_ENTRY(name, bakeScale, isMipmapped) { name, bakeScale, isMipmapped },
+    static const struct {
+        const char* file;
+        float scale;
+        bool isMipmapped;
+    } bakedTextures[] = {
+        BAKED_TEXTURE_LIST(BAKED_TEXTURE_ENTRY)
+    };
+#undef BAKED_TEXTURE_ENTRY
+
+    float scale = 1.0f;
+    TextureFilter filter = TEXTURE_FILTER_POINT;
+    const char* path = TextFormat("%s/%s", directory, file);
+    for (size_t i = 0; i < sizeof(bakedTextures) / sizeof(bakedTextures[0]); i++) {
+        if (strcmp(bakedTextures[i].file, file) != 0) continue;
+
+        filter = bakedTextures[i].isMipmapped ? TEXTURE_FILTER_TRILINEAR : TEXTURE_FILTER_BILINEAR;
+        const char* bakedPath = TextFormat("%s/baked/%s", directory, file);
+        if (AssetFileExists(bakedPath)) {
+            path = bakedPath;
+            scale = bakedTextures[i].scale;
+        }
+        break;
+    }
+    QueueTextureEx(texture, path, stage, filter);
+    return scale;
+}
+
+// A loose sprite is its whole texture, whose size is only known once it has loaded
+static const Sprite* getSprite(SpriteId id) {
+    Sprite* sprite = &sprites[id];
+    if (isLoose) {
+        Texture2D texture = pages[sprite->page];
+        sprite->rect = (Rectangle) { 0, 0, texture.width, texture.height };
+        sprite->width = texture.width;
+        sprite->height = texture.height;
+    }
+    return sprite;
+}
+
+void UnloadSprites(void) {
+    for (int i = 0; i < pageCount; i++) {
+        UnloadTexture(pages[i]);
+    }
+    pageCount = 0;
+}
+
+const char* GetSpriteFileName(SpriteId id) {
+    return spriteFiles[id];
+}
+
+float GetSpriteBakeScale(SpriteId id) {
+    return spriteBakeScales[id];
+}
+
+Vector2 GetSpriteSize(SpriteId id) {
+    const Sprite* sprite = getSprite(id);
+    return (Vector2) { sprite->width, sprite->height };
+}
+
+Texture2D ResolveSprite(SpriteId id, Rectangle* source) {
+    const Sprite* sprite = getSprite(id);
+    if (sprite->width == 0.0f || sprite->height == 0.0f) return pages[sprite->page];
+    float scaleX = sprite->rect.width / sprite->width;
+    float scaleY = sprite->rect.height / sprite->height;
+
+    // A negative source width or height still flips, since only the offset into the page is rescaled
+    *source = (Rectangle) {
+        sprite->rect.x + source->x * scaleX,
+        sprite->rect.y + source->y * scaleY,
+        source->width * scaleX,
+        source->height * scaleY
+    };
+    return pages[sprite->page];
+}
+
+void DrawSprite(SpriteId id, Rectangle source, Rectangle dest, Vector2 origin, float rotation, Color tint) {
+    Texture2D texture = ResolveSprite(id, &source);
+    DrawTexturePro(texture, source, dest, origin, rotation, tint);
+}
@@ -0,0 +1,78 @@
+#ifndef SPRITES_H
+#define SPRITES_H
+
+#include <stdbool.h>
+#include "raylib.h"
+#include "assets.h"
+
+#define ATLAS_PAGE_SIZE 2048
+#define ATLAS_PADDING 8
+#define MAX_ATLAS_PAGES 8
+#define ATLAS_TABLE_FILE "atlas.rects"
+
+// Gameplay sprites packed into the atlas, in the order of the generated rect table
+// The bake scale matches the size each sprite is drawn at in main.c; sprites drawn at varying sizes keep theirs
+// and rely on the atlas mip chain
+#define SPRITE_LIST(X) \
+    X(SPRITE_RATS, "rats.png", 1.0f) \
+    X(SPRITE_EXPLOSIVE_RAT, "explosive_rat.png", 1.0f) \
+    X(SPRITE_FAT_RAT, "fatrat.png", 1.0f) \
+    X(SPRITE_FAT_RAT_HAPPY, "fatrat_happy.png", 1.0f) \
+    X(SPRITE_PLAYER, "player_spritesheet.png", 0.5f) \
+    X(SPRITE_SCARS1, "scars1.png", 0.5f) \
+    X(SPRITE_SCARS2, "scars2.png", 0.5f) \
+    X(SPRITE_CHEESE, "cheese_normal.png", 0.125f) \
+    X(SPRITE_CHEESE_WALK1, "cheese_walk1.png", 0.125f) \
+    X(SPRITE_CHEESE_WALK2, "cheese_walk2.png", 0.125f) \
+    X(SPRITE_HAND, "hand.png", 0.5f) \
+    X(SPRITE_HAND_RAT, "hand_rat.png", 0.5f) \
+    X(SPRITE_HAND_CHEESE, "hand_cheese.png", 0.5f) \
+    X(SPRITE_POWER_GENERATOR, "power_generator.png", 1.0f) \
+    X(SPRITE_ELECTRICITY, "elec.png", 0.25f) \
+    X(SPRITE_POOF, "poof.png", 1.0f) \
+    X(SPRITE_NOM, "nom.png", 1.0f) \
+    X(SPRITE_BLOOD, "blood.png", 1.0f) \
+    X(SPRITE_EXPLOSION, "boom.png", 1.0f) \
+    X(SPRITE_SPACE_BUTTON, "space_button.png", 1.0f)
+
+// Textures drawn on their own, baked to baked/<file> at the scale they are drawn at. Mipmapped ones are drawn
+// at sizes that change over time.
+#define BAKED_TEXTURE_LIST(X) \
+    X("spotlight.png", 0.5f, false) \
+    X("red_flash.png", 0.5f, false) \
+    X("falling.png", 1.0f, true)
+
+#define SPRITE_ENUM(id, file, bakeScale) id,
+typedef enum {
+    SPRITE_LIST(SPRITE_ENUM)
+    SPRITE_COUNT
+} SpriteId;
+#undef SPRITE_ENUM
+
+typedef struct {
+    int page;
+    Rectangle rect;
+    float width;
+    float height;
+} Sprite;
+
+// Queues the baked atlas from directory/baked, or each sprite's own file when the atlas has not been baked.
+// Sprites have zero size until their texture has loaded.
+void QueueSprites(const char* directory, AssetStage stage);
+
+// Queues a texture from BAKED_TEXTURE_LIST, falling back to the original when it has not been baked.
+// Returns the scale of the queued file, to recover the size the texture is meant to be drawn at.
+float QueueBakedTexture(Texture2D* texture, const char* directory, const char* file, AssetStage stage);
+void UnloadSprites(void);
+
+const char* GetSpriteFileName(SpriteId id);
+float GetSpriteBakeScale(SpriteId id);
+Vector2 GetSpriteSize(SpriteId id);
+
+// Returns the texture holding the sprite and rewrites source from sprite pixels into that texture's pixels
+Texture2D ResolveSprite(SpriteId id, Rectangle* source);
+
+// Like DrawTexturePro, with source given in the sprite's own pixel space
+void DrawSprite(SpriteId id, Rectangle source, Rectangle dest, Vector2 origin, float rotation, Color tint);
+
+#endif
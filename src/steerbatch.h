@@ -0,0 +1,122 @@
+// The vector steering kernel, included by steering.c once for each instruction set it is built for. The includer
+// defines vfloat, the v* operations, STEER_LANES and STEER_TARGET, and may rename vfacingAngle, steerBatch and
+// steerRange so several copies can live side by side; everything is undefined again at the end.
+
+static inline STEER_TARGET vfloat vfacingAngle(vfloat y, vfloat x) {
+    vfloat zero = vset(0.0f);
+    vfloat ax = vabs(x);
+    vfloat ay = vabs(y);
+    vfloat isSteep = vlt(ax, ay);
+    vfloat low = vselect(isSteep, ax, ay);
+    vfloat high = vselect(isSteep, ay, ax);
+    vfloat a = vselect(vlt(zero, high), vdiv(low, high), zero);
+    vfloat s = vmul(a, a);
+    vfloat r = vadd(vset(ATAN_C4), vmul(s, vset(ATAN_C5)));
+    r = vadd(vset(ATAN_C3), vmul(s, r));
+    r = vadd(vset(ATAN_C2), vmul(s, r));
+    r = vadd(vset(ATAN_C1), vmul(s, r));
+    r = vmul(a, vadd(vset(ATAN_C0), vmul(s, r)));
+    r = vselect(vlt(ax, ay), vsub(vset(HALF_PI), r), r);
+    r = vselect(vlt(x, zero), vsub(vset(PI), r), r);
+    r = vselect(vlt(y, zero), vsub(zero, r), r);
+    r = vselect(vlt(r, zero), vadd(r, vset(TWO_PI)), r);
+    return vadd(vmul(r, vset(RADIANS_TO_DEGREES)), vset(90.0f));
+}
+
+// Adds each lane's damage to the running total one rat at a time, so the sum doesn't depend on the batch width
+static STEER_TARGET float steerBatch(RatStore* store, const SteerParams* params, int i, float total) {
+    vfloat zero = vset(0.0f);
+    vfloat deltaTime = vset(params->deltaTime);
+    vfloat targetX = vset(params->target.x);
+    vfloat targetY = vset(params->target.y);
+
+    vfloat isHeld = vflag(&store->flags[i], RAT_HELD);
+    vfloat isThrown = vlt(zero, vload(&store->throwTimer[i]));
+    vfloat isSeeking = vandnot(isHeld, vandnot(isThrown, vlt(zero, vset(1.0f))));
+
+    vfloat px = vload(&store->positionX[i]);
+    vfloat py = vload(&store->positionY[i]);
+    vfloat type = vloadtype(&store->type[i]);
+    vfloat speed = vselect(vflag(&store->flags[i], RAT_ENRAGED),
+                           vset(params->speed * params->enragedMultiplier), vset(params->speed));
+
+    vfloat dx = vsub(targetX, px);
+    vfloat dy = vsub(targetY, py);
+    vfloat length = vsqrt(vadd(vmul(dx, dx), vmul(dy, dy)));
+    vfloat hasLength = vlt(zero, length);
+    vfloat vx = vselect(hasLength, vmul(vdiv(dx, length), speed), zero);
+    vfloat vy = vselect(hasLength, vmul(vdiv(dy, length), speed), zero);
+    vfloat nx = vadd(px, vmul(vmul(vx, deltaTime), type));
+    vfloat ny = vadd(py, vmul(vmul(vy, deltaTime), type));
+
+    dx = vsub(targetX, nx);
+    dy = vsub(targetY, ny);
+    vfloat distanceToTarget = vsqrt(vadd(vmul(dx, dx), vmul(dy, dy)));
+    vfloat size = vload(&store->scale[i]);
+    vfloat hasArrived = vlt(distanceToTarget, vmul(size, vset(params->arrivalFactor)));
+    vx = vandnot(hasArrived, vx);
+    vy = vandnot(hasArrived, vy);
+
+    vfloat rotation = vload(&store->rotation[i]);
+    vfloat facing = vfacingAngle(dy, dx);
+    vfloat isTurning = params->alwaysFacesTarget ? isSeeking : vandnot(hasArrived, isSeeking);
+    vstore(&store->rotation[i], vselect(isTurning, facing, rotation));
+    vstore(&store->positionX[i], vselect(isSeeking, nx, px));
+    vstore(&store->positionY[i], vselect(isSeeking, ny, py));
+    vstore(&store->velocityX[i], vselect(isSeeking, vx, vload(&store->velocityX[i])));
+    vstore(&store->velocityY[i], vselect(isSeeking, vy, vload(&store->velocityY[i])));
+
+    vfloat inContact = vand(isSeeking, vlt(distanceToTarget, vmul(size, vset(params->contactFactor))));
+    vfloat damage = vand(inContact, vmul(vmul(vset(params->damageRate), deltaTime), type));
+
+    float lanes[STEER_LANES];
+    vstore(lanes, damage);
+    for (int lane = 0; lane < STEER_LANES; lane++) {
+        total += lanes[lane];
+    }
+
+    // Thrown rats are rare, so they take the scalar path once the seeking lanes are written
+    int thrownLanes = vmask(vandnot(isHeld, isThrown));
+    for (int lane = 0; thrownLanes != 0; lane++, thrownLanes >>= 1) {
+        if (thrownLanes & 1) {
+            steerOne(store, params, i + lane);
+        }
+    }
+
+    return total;
+}
+
+static STEER_TARGET float steerRange(RatStore* store, const SteerParams* params, int begin, int end) {
+    float damage = 0.0f;
+    int i = begin;
+    for (; i + STEER_LANES <= end; i += STEER_LANES) {
+        damage = steerBatch(store, params, i, damage);
+    }
+    for (; i < end; i++) {
+        damage += steerOne(store, params, i);
+    }
+    return damage;
+}
+
+#undef vfloat
+#undef vload
+#undef vstore
+#undef vset
+#undef vadd
+#undef vsub
+#undef vmul
+#undef vdiv
+#undef vsqrt
+#undef vabs
+#undef vlt
+#undef vand
+#undef vandnot
+#undef vselect
+#undef vmask
+#undef vloadtype
+#undef vflag
+#undef vfacingAngle
+#undef steerBatch
+#undef steerRange
+#undef STEER_LANES
+#undef STEER_TARGET
@@ -0,0 +1,250 @@
+#include "steering.h"
+
+#include <math.h>
+#include <string.h>
+
+// Baseline x86-64 builds from GCC or Clang carry both the SSE2 and AVX2 kernels and pick one by what the CPU supports
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define STEER_AVX2
+#elif defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(_MSC_VER)
+#include <immintrin.h>
+#define STEER_SSE2
+#define STEER_AVX2
+#define STEER_DISPATCH
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define STEER_SSE2
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define STEER_WASM
+#endif
+
+#define ATAN_C0 0.99997726f
+#define ATAN_C1 -0.33262347f
+#define ATAN_C2 0.19354346f
+#define ATAN_C3 -0.11643287f
+#define ATAN_C4 0.05265332f
+#define ATAN_C5 -0.01172120f
+
+#define HALF_PI 1.57079632f
+#define TWO_PI 6.28318531f
+#define RADIANS_TO_DEGREES 57.2957795f
+
+// Polynomial atan2 shared by every path so scalar and vector lanes agree; about 1e-5 rad of error
+static float facingAngle(float y, float x) {
+    float ax = fabsf(x);
+    float ay = fabsf(y);
+    float low = ax < ay ? ax : ay;
+    float high = ax < ay ? ay : ax;
+    float a = high > 0.0f ? low / high : 0.0f;
+    float s = a * a;
+    float r = a * (ATAN_C0 + s * (ATAN_C1 + s * (ATAN_C2 + s * (ATAN_C3 + s * (ATAN_C4 + s * ATAN_C5)))));
+    if (ay > ax) r = HALF_PI - r;
+    if (x < 0.0f) r = PI - r;
+    if (y < 0.0f) r = -r;
+    if (r < 0.0f) r += TWO_PI;
+    return r * RADIANS_TO_DEGREES + 90.0f;
+}
+
+static float steerOne(RatStore* store, const SteerParams* params, int i) {
+    if (store->flags[i] & RAT_HELD) return 0.0f;
+
+    float px = store->positionX[i];
+    float py = store->positionY[i];
+
+    if (store->throwTimer[i] > 0.0f) {
+        store->throwTimer[i] -= params->deltaTime;
+        float dx = store->throwX[i] - px;
+        float dy = store->throwY[i] - py;
+        float length = sqrtf(dx * dx + dy * dy);
+        float vx = length > 0.0f ? dx / length * params->throwSpeed : 0.0f;
+        float vy = length > 0.0f ? dy / length * params->throwSpeed : 0.0f;
+        store->velocityX[i] = vx;
+        store->velocityY[i] = vy;
+        store->positionX[i] = px + vx * params->deltaTime;
+        store->positionY[i] = py + vy * params->deltaTime;
+        return 0.0f;
+    }
+
+    float type = (float) store->type[i];
+    float speed = store->flags[i] & RAT_ENRAGED ? params->speed * params->enragedMultiplier : params->speed;
+    float dx = params->target.x - px;
+    float dy = params->target.y - py;
+    float length = sqrtf(dx * dx + dy * dy);
+    float vx = length > 0.0f ? dx / length * speed : 0.0f;
+    float vy = length > 0.0f ? dy / length * speed : 0.0f;
+    px = px + vx * params->deltaTime * type;
+    py = py + vy * params->deltaTime * type;
+
+    dx = params->target.x - px;
+    dy = params->target.y - py;
+    float distanceToTarget = sqrtf(dx * dx + dy * dy);
+    float size = store->scale[i];
+
+    bool hasArrived = distanceToTarget < size * params->arrivalFactor;
+    if (hasArrived) {
+        vx = 0.0f;
+        vy = 0.0f;
+    }
+    if (!hasArrived || params->alwaysFacesTarget) {
+        store->rotation[i] = facingAngle(dy, dx);
+    }
+
+    store->positionX[i] = px;
+    store->positionY[i] = py;
+    store->velocityX[i] = vx;
+    store->velocityY[i] = vy;
+
+    return distanceToTarget < size * params->contactFactor ? params->damageRate * params->deltaTime * type : 0.0f;
+}
+
+#if defined(STEER_AVX2)
+
+#if defined(STEER_DISPATCH)
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define AVX2_TARGET
+#endif
+
+static inline AVX2_TARGET __m256 avx2Flag(const uint8_t* p, int bit) {
+    __m256i flags = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*) p));
+    __m256i bits = _mm256_set1_epi32(bit);
+    return _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(flags, bits), bits));
+}
+
+#define vfloat __m256
+#define vload(p) _mm256_loadu_ps(p)
+#define vstore(p, v) _mm256_storeu_ps(p, v)
+#define vset(x) _mm256_set1_ps(x)
+#define vadd(a, b) _mm256_add_ps(a, b)
+#define vsub(a, b) _mm256_sub_ps(a, b)
+#define vmul(a, b) _mm256_mul_ps(a, b)
+#define vdiv(a, b) _mm256_div_ps(a, b)
+#define vsqrt(a) _mm256_sqrt_ps(a)
+#define vabs(a) _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a)
+#define vlt(a, b) _mm256_cmp_ps(a, b, _CMP_LT_OQ)
+#define vand(a, b) _mm256_and_ps(a, b)
+#define vandnot(mask, a) _mm256_andnot_ps(mask, a)
+#define vselect(mask, a, b) _mm256_blendv_ps(b, a, mask)
+#define vmask(mask) _mm256_movemask_ps(mask)
+#define vloadtype(p) _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*) (p)))
+#define vflag(p, bit) avx2Flag(p, bit)
+#define vfacingAngle avx2FacingAngle
+#define steerBatch avx2SteerBatch
+#define steerRange avx2SteerRange
+#define STEER_LANES 8
+#define STEER_TARGET AVX2_TARGET
+#include "steerbatch.h"
+
+#endif
+
+#if defined(STEER_SSE2)
+
+static inline __m128 sse2Flag(const uint8_t* p, int bit) {
+    uint32_t packed;
+    memcpy(&packed, p, sizeof(packed));
+    __m128i zero = _mm_setzero_si128();
+    __m128i flags = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128((int) packed), zero), zero);
+    __m128i bits = _mm_set1_epi32(bit);
+    return _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(flags, bits), bits));
+}
+
+#define vfloat __m128
+#define vload(p) _mm_loadu_ps(p)
+#define vstore(p, v) _mm_storeu_ps(p, v)
+#define vset(x) _mm_set1_ps(x)
+#define vadd(a, b) _mm_add_ps(a, b)
+#define vsub(a, b) _mm_sub_ps(a, b)
+#define vmul(a, b) _mm_mul_ps(a, b)
+#define vdiv(a, b) _mm_div_ps(a, b)
+#define vsqrt(a) _mm_sqrt_ps(a)
+#define vabs(a) _mm_andnot_ps(_mm_set1_ps(-0.0f), a)
+#define vlt(a, b) _mm_cmplt_ps(a, b)
+#define vand(a, b) _mm_and_ps(a, b)
+#define vandnot(mask, a) _mm_andnot_ps(mask, a)
+#define vselect(mask, a, b) _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b))
+#define vmask(mask) _mm_movemask_ps(mask)
+#define vloadtype(p) _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*) (p)))
+#define vflag(p, bit) sse2Flag(p, bit)
+#define vfacingAngle sse2FacingAngle
+#define steerBatch sse2SteerBatch
+#define steerRange sse2SteerRange
+#define STEER_LANES 4
+#define STEER_TARGET
+#include "steerbatch.h"
+
+#endif
+
+#if defined(STEER_WASM)
+
+static inline v128_t wasmFlag(const uint8_t* p, int bit) {
+    uint32_t packed;
+    memcpy(&packed, p, sizeof(packed));
+    v128_t flags = wasm_u32x4_extend_low_u16x8(wasm_u16x8_extend_low_u8x16(wasm_i32x4_splat((int) packed)));
+    v128_t bits = wasm_i32x4_splat(bit);
+    return wasm_i32x4_eq(wasm_v128_and(flags, bits), bits);
+}
+
+#define vfloat v128_t
+#define vload(p) wasm_v128_load(p)
+#define vstore(p, v) wasm_v128_store(p, v)
+#define vset(x) wasm_f32x4_splat(x)
+#define vadd(a, b) wasm_f32x4_add(a, b)
+#define vsub(a, b) wasm_f32x4_sub(a, b)
+#define vmul(a, b) wasm_f32x4_mul(a, b)
+#define vdiv(a, b) wasm_f32x4_div(a, b)
+#define vsqrt(a) wasm_f32x4_sqrt(a)
+#define vabs(a) wasm_f32x4_abs(a)
+#define vlt(a, b) wasm_f32x4_lt(a, b)
+#define vand(a, b) wasm_v128_and(a, b)
+#define vandnot(mask, a) wasm_v128_andnot(a, mask)
+#define vselect(mask, a, b) wasm_v128_bitselect(a, b, mask)
+#define vmask(mask) wasm_i32x4_bitmask(mask)
+#define vloadtype(p) wasm_f32x4_convert_i32x4(wasm_v128_load(p))
+#define vflag(p, bit) wasmFlag(p, bit)
+#define vfacingAngle wasmFacingAngle
+#define steerBatch wasmSteerBatch
+#define steerRange wasmSteerRange
+#define STEER_LANES 4
+#define STEER_TARGET
+#include "steerbatch.h"
+
+#endif
+
+#if defined(STEER_DISPATCH)
+// GCC and Clang read the CPU features once at startup, so asking on every call is cheap
+static bool useAvx2(void) {
+    return __builtin_cpu_supports("avx2");
+}
+#endif
+
+float SteerRats(RatStore* store, const SteerParams* params, int begin, int end) {
+#if defined(STEER_DISPATCH)
+    return useAvx2() ? avx2SteerRange(store, params, begin, end) : sse2SteerRange(store, params, begin, end);
+#elif defined(STEER_AVX2)
+    return avx2SteerRange(store, params, begin, end);
+#elif defined(STEER_SSE2)
+    return sse2SteerRange(store, params, begin, end);
+#elif defined(STEER_WASM)
+    return wasmSteerRange(store, params, begin, end);
+#else
+    float damage = 0.0f;
+    for (int i = begin; i < end; i++) {
+        damage += steerOne(store, params, i);
+    }
+    return damage;
+#endif
+}
+
+int GetSteerBatchWidth(void) {
+#if defined(STEER_DISPATCH)
+    return useAvx2() ? 8 : 4;
+#elif defined(STEER_AVX2)
+    return 8;
+#elif defined(STEER_SSE2) || defined(STEER_WASM)
+    return 4;
+#else
+    return 1;
+#endif
+}
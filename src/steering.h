@@ -0,0 +1,26 @@
+#ifndef STEERING_H
+#define STEERING_H
+
+#include "ratstore.h"
+
+typedef struct {
+    Vector2 target;
+    float deltaTime;
+    float speed;
+    float enragedMultiplier;
+    float throwSpeed;
+    float arrivalFactor;
+    float contactFactor;
+    float damageRate;
+    bool alwaysFacesTarget;
+} SteerParams;
+
+// Seeks every rat in [begin, end) towards the target, or along its throw while throwTimer is running.
+// Arrived rats stop turning unless alwaysFacesTarget is set. Rats flagged RAT_HELD are left untouched.
+// Returns the damage dealt by rats in contact with the target.
+float SteerRats(RatStore* store, const SteerParams* params, int begin, int end);
+
+// Width of the vector path; ranges starting on a multiple of it produce the same results as one full call
+int GetSteerBatchWidth(void);
+
+#endif
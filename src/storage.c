@@ -0,0 +1,80 @@
+#include "storage.h"
+
+#include "raylib.h"
+
+#if defined(__EMSCRIPTEN__)
+
+#include <emscripten/emscripten.h>
+
+static bool isReady = false;
+static bool isSyncing = false;
+static bool isFlushPending = false;
+
+// Called from JavaScript when a load from or write to IndexedDB finishes. Only one sync may run at a time,
+// so flushes asked for in the meantime are merged into one that starts now.
+void EMSCRIPTEN_KEEPALIVE storageSynced(void) {
+    isSyncing = false;
+    isReady = true;
+    if (isFlushPending) {
+        isFlushPending = false;
+        FlushStorage();
+    }
+}
+
+void MountStorage(void) {
+    isSyncing = true;
+    EM_ASM({
+        FS.mkdir('/save');
+        FS.mount(IDBFS, {}, '/save');
+        FS.syncfs(true, function (error) {
+            if (error) console.warn('STORAGE: Could not load saved files', error);
+            _storageSynced();
+        });
+    });
+}
+
+bool IsStorageReady(void) {
+    return isReady;
+}
+
+void FlushStorage(void) {
+    if (!isReady) return;
+    if (isSyncing) {
+        isFlushPending = true;
+        return;
+    }
+    isSyncing = true;
+    EM_ASM({
+        FS.syncfs(false, function (error) {
+            if (error) console.warn('STORAGE: Could not save files', error);
+            _storageSynced();
+        });
+    });
+}
+
+#else
+
+#if defined(_WIN32)
+#include <direct.h>
+#define makeDirectory(path) _mkdir(path)
+#else
+#include <sys/stat.h>
+#define makeDirectory(path) mkdir(path, 0755)
+#endif
+
+void MountStorage(void) {
+    if (!DirectoryExists(STORAGE_DIRECTORY)) makeDirectory(STORAGE_DIRECTORY);
+}
+
+bool IsStorageReady(void) {
+    return true;
+}
+
+void FlushStorage(void) {
+}
+
+#endif
+
+const char* GetStoragePath(const char* name) {
+    return TextFormat("%s/%s", STORAGE_DIRECTORY, name);
+}
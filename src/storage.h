@@ -0,0 +1,23 @@
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <stdbool.h>
+
+// Files that outlive the session: an IndexedDB-backed IDBFS mount in the browser, a plain directory elsewhere
+#if defined(__EMSCRIPTEN__)
+#define STORAGE_DIRECTORY "/save"
+#else
+#define STORAGE_DIRECTORY "save"
+#endif
+
+// Starts loading the saved files; in the browser they are only readable once IsStorageReady returns true
+void MountStorage(void);
+bool IsStorageReady(void);
+
+// Path of a saved file, from raylib's TextFormat buffers
+const char* GetStoragePath(const char* name);
+
+// Writes changed files back to IndexedDB in the background. Native files are already on disk once written.
+void FlushStorage(void);
+
+#endif
@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "raylib.h"
+#include "sprites.h"
+
+// Packs the gameplay sprites listed in sprites.h into atlas pages plus a rect table, and writes the textures
+// in BAKED_TEXTURE_LIST at the scale they are drawn at
+// Usage: crazy_bake <resources directory> <output directory>
+
+typedef struct {
+    Image image;
+    int sourceWidth, sourceHeight;
+    int page;
+    int x, y;
+} PackedSprite;
+
+static PackedSprite packed[SPRITE_COUNT];
+
+static int compareByHeight(const void* a, const void* b) {
+    int left = *(const int*) a;
+    int right = *(const int*) b;
+    int difference = packed[right].image.height - packed[left].image.height;
+    return difference != 0 ? difference : left - right;
+}
+
+static int packSprites(void) {
+    int order[SPRITE_COUNT];
+    for (int i = 0; i < SPRITE_COUNT; i++) order[i] = i;
+    qsort(order, SPRITE_COUNT, sizeof(int), compareByHeight);
+
+    // Shelf packing, tallest first: each shelf is as tall as its first sprite
+    int page = 0, shelfX = 0, shelfY = 0, shelfHeight = 0;
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+        PackedSprite* sprite = &packed[order[i]];
+        int w = sprite->image.width + ATLAS_PADDING * 2;
+        int h = sprite->image.height + ATLAS_PADDING * 2;
+        if (w > ATLAS_PAGE_SIZE || h > ATLAS_PAGE_SIZE) {
+            TraceLog(LOG_ERROR, "BAKE: %s does not fit in an atlas page", GetSpriteFileName(order[i]));
+            return -1;
+        }
+
+        if (shelfX + w > ATLAS_PAGE_SIZE) {
+            shelfX = 0;
+            shelfY += shelfHeight;
+            shelfHeight = 0;
+        }
+        if (shelfY + h > ATLAS_PAGE_SIZE) {
+            page++;
+            shelfX = 0;
+            shelfY = 0;
+            shelfHeight = 0;
+        }
+        if (page >= MAX_ATLAS_PAGES) {
+            TraceLog(LOG_ERROR, "BAKE: Sprites need more than %i atlas pages", MAX_ATLAS_PAGES);
+            return -1;
+        }
+
+        sprite->page = page;
+        sprite->x = shelfX + ATLAS_PADDING;
+        sprite->y = shelfY + ATLAS_PADDING;
+        shelfX += w;
+        if (h > shelfHeight) shelfHeight = h;
+    }
+    return page + 1;
+}
+
+static bool bakeTexture(const char* input, const char* output, const char* file, float scale) {
+    Image image = LoadImage(TextFormat("%s/%s", input, file));
+    if (image.data == NULL) return false;
+    if (scale != 1.0f) ImageResize(&image, (int) (image.width * scale), (int) (image.height * scale));
+
+    bool isExported = ExportImage(image, TextFormat("%s/%s", output, file));
+    UnloadImage(image);
+    return isExported;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <resources directory> <output directory>\n", argv[0]);
+        return 1;
+    }
+    const char* input = argv[1];
+    const char* output = argv[2];
+
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+        packed[i].image = LoadImage(TextFormat("%s/%s", input, GetSpriteFileName(i)));
+        if (packed[i].image.data == NULL) return 1;
+        ImageFormat(&packed[i].image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+        packed[i].sourceWidth = packed[i].image.width;
+        packed[i].sourceHeight = packed[i].image.height;
+        float scale = GetSpriteBakeScale(i);
+        if (scale != 1.0f) {
+            ImageResize(&packed[i].image, (int) (packed[i].sourceWidth * scale), (int) (packed[i].sourceHeight * scale));
+        }
+    }
+
+    int pageCount = packSprites();
+    if (pageCount < 0) return 1;
+
+    char* table = MemAlloc(64 * (SPRITE_COUNT + 1) + 1024);
+    int length = sprintf(table, "pages %d\n", pageCount);
+
+    for (int page = 0; page < pageCount; page++) {
+        Image atlas = GenImageColor(ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, BLANK);
+        for (int i = 0; i < SPRITE_COUNT; i++) {
+            PackedSprite* sprite = &packed[i];
+            if (sprite->page != page) continue;
+
+            // Repeat the edge pixels into the padding so filtering and the first mip levels never sample a neighbour
+            Rectangle source = { 0, 0, sprite->image.width, sprite->image.height };
+            for (int p = ATLAS_PADDING; p > 0; p--) {
+                ImageDraw(&atlas, sprite->image, (Rectangle) { 0, 0, 1, source.height },
+                          (Rectangle) { sprite->x - p, sprite->y, 1, source.height }, WHITE);
+                ImageDraw(&atlas, sprite->image, (Rectangle) { source.width - 1, 0, 1, source.height },
+                          (Rectangle) { sprite->x + source.width - 1 + p, sprite->y, 1, source.height }, WHITE);
+                ImageDraw(&atlas, sprite->image, (Rectangle) { 0, 0, source.width, 1 },
+                          (Rectangle) { sprite->x, sprite->y - p, source.width, 1 }, WHITE);
+                ImageDraw(&atlas, sprite->image, (Rectangle) { 0, source.height - 1, source.width, 1 },
+                          (Rectangle) { sprite->x, sprite->y + source.height - 1 + p, source.width, 1 }, WHITE);
+            }
+            ImageDraw(&atlas, sprite->image, source,
+                      (Rectangle) { sprite->x, sprite->y, source.width, source.height }, WHITE);
+        }
+        if (!ExportImage(atlas, TextFormat("%s/atlas%i.png", output, page))) return 1;
+        UnloadImage(atlas);
+    }
+
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+        PackedSprite* sprite = &packed[i];
+        length += sprintf(table + length, "%s %d %d %d %d %d %d %d\n", GetSpriteFileName(i), sprite->page,
+                          sprite->x, sprite->y, sprite->image.width, sprite->image.height,
+                          sprite->sourceWidth, sprite->sourceHeight);
+        UnloadImage(sprite->image);
+    }
+
+    bool isSaved = SaveFileText(TextFormat("%s/%s", output, ATLAS_TABLE_FILE), table);
+    MemFree(table);
+    if (!isSaved) return 1;
+
+#define BAKE_TEXTURE(file, bakeScale, isMipmapped) if (!bakeTexture(input, output, file, bakeScale)) return 1;
+    BAKED_TEXTURE_LIST(BAKE_TEXTURE)
+#undef BAKE_TEXTURE
+    return 0;
+}
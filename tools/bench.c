@@ -0,0 +1,227 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ratstore.h"
+#include "spatialgrid.h"
+#include "steering.h"
+#include "random.h"
+#include "gamemath.h"
+
+// Times the simulation kernels at increasing entity counts and prints the results as JSON
+// Usage: crazy_bench [--filter <kernel name substring>] [--max <entity count>]
+
+#define ARENA_SIZE 1024.0f
+#define GRID_CELL_SIZE 64.0f
+#define SCALE_FACTOR 100.0f
+#define MAX_QUERIES 4096
+#define SAMPLE_COUNT 7
+#define MIN_SAMPLE_SECONDS 0.01
+
+static const int ENTITY_COUNTS[] = { 10, 100, 1000, 10000, 100000 };
+
+typedef struct {
+    RatStore store;
+    SpatialGrid grid;
+    RandomStream random;
+    Vector2* points;
+    int queryCount;
+    volatile float sink;
+} BenchState;
+
+typedef void (*KernelFunction)(BenchState* state);
+
+typedef struct {
+    const char* name;
+    KernelFunction run;
+    bool perQuery;
+} Kernel;
+
+static double now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+static float randomCoordinate(BenchState* state) {
+    return (float) RandomInt(&state->random, (int) ARENA_SIZE);
+}
+
+// Rats scattered over the arena with the type and scale mix of a late level
+static void populate(BenchState* state, int count) {
+    ClearRatStore(&state->store);
+    SeedRandom(&state->random, 42, (uint64_t) count);
+    for (int i = 0; i < count; i++) {
+        Vector2 position = { randomCoordinate(state), randomCoordinate(state) };
+        int type = 1 + RandomInt(&state->random, 4);
+        SpawnRat(&state->store, position, type);
+        state->store.scale[i] = type * 0.25f;
+        if (RandomInt(&state->random, 8) == 0) state->store.flags[i] |= RAT_ENRAGED;
+    }
+
+    state->queryCount = count < MAX_QUERIES ? count : MAX_QUERIES;
+    for (int i = 0; i < state->queryCount; i++) {
+        state->points[i] = GetRatPosition(&state->store, i);
+    }
+    BuildSpatialGrid(&state->grid, &state->store);
+}
+
+static void runSteering(BenchState* state) {
+    SteerParams params = {
+        .target = { ARENA_SIZE * 0.5f, ARENA_SIZE * 0.5f },
+        .deltaTime = 1.0f / 120.0f,
+        .speed = 100.0f,
+        .enragedMultiplier = 2.0f,
+        .throwSpeed = 300.0f,
+        .arrivalFactor = SCALE_FACTOR * 1.5f,
+        .contactFactor = SCALE_FACTOR,
+        .damageRate = 1.0f
+    };
+    state->sink += SteerRats(&state->store, &params, 0, state->store.count);
+}
+
+static void runGridBuild(BenchState* state) {
+    BuildSpatialGrid(&state->grid, &state->store);
+    state->sink += state->grid.maxScale;
+}
+
+// OnDropRat: every rat within the dropped rat's size
+static void runMergeSearch(BenchState* state) {
+    int found = 0;
+    for (int i = 0; i < state->queryCount; i++) {
+        found += QueryGridRadius(&state->grid, &state->store, state->points[i], state->store.scale[i] * SCALE_FACTOR);
+    }
+    state->sink += found;
+}
+
+// UpdateCheese: the rat closest to the cheese within 1000 pixels
+static void runClosestSearch(BenchState* state) {
+    int found = 0;
+    for (int i = 0; i < state->queryCount; i++) {
+        found += FindNearestRat(&state->grid, &state->store, state->points[i], 1000.0f);
+    }
+    state->sink += found;
+}
+
+// UpdateMouseLogic: every rat caught in an explosion
+static void runExplosionRadius(BenchState* state) {
+    int found = 0;
+    for (int i = 0; i < state->queryCount; i++) {
+        found += QueryGridRadiusOrdered(&state->grid, &state->store, state->points[i], 150.0f);
+    }
+    state->sink += found;
+}
+
+static void runDistance(BenchState* state) {
+    Vector2 target = { ARENA_SIZE * 0.5f, ARENA_SIZE * 0.5f };
+    float total = 0.0f;
+    for (int i = 0; i < state->store.count; i++) {
+        total += distance(GetRatPosition(&state->store, i), target);
+    }
+    state->sink += total;
+}
+
+static void runNormalize(BenchState* state) {
+    Vector2 target = { ARENA_SIZE * 0.5f + 0.5f, ARENA_SIZE * 0.5f + 0.5f };
+    float total = 0.0f;
+    for (int i = 0; i < state->store.count; i++) {
+        Vector2 direction = normalize(getDirection(GetRatPosition(&state->store, i), target));
+        total += direction.x + direction.y;
+    }
+    state->sink += total;
+}
+
+static void runLookAt(BenchState* state) {
+    Vector2 target = { ARENA_SIZE * 0.5f, ARENA_SIZE * 0.5f };
+    float total = 0.0f;
+    for (int i = 0; i < state->store.count; i++) {
+        total += lookAt(GetRatPosition(&state->store, i), target);
+    }
+    state->sink += total;
+}
+
+static const Kernel KERNELS[] = {
+    { "steer_rats", runSteering, false },
+    { "grid_build", runGridBuild, false },
+    { "merge_search", runMergeSearch, true },
+    { "closest_rat", runClosestSearch, true },
+    { "explosion_radius", runExplosionRadius, true },
+    { "distance", runDistance, false },
+    { "normalize", runNormalize, false },
+    { "look_at", runLookAt, false },
+};
+
+static int compareDoubles(const void* a, const void* b) {
+    double left = *(const double*) a;
+    double right = *(const double*) b;
+    return (left > right) - (left < right);
+}
+
+int main(int argc, char** argv) {
+    const char* filter = NULL;
+    int maxEntities = ENTITY_COUNTS[sizeof(ENTITY_COUNTS) / sizeof(ENTITY_COUNTS[0]) - 1];
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--max") == 0 && i + 1 < argc) {
+            maxEntities = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [--filter <kernel>] [--max <entities>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    static BenchState state;
+    InitRatStore(&state.store, 64);
+    InitSpatialGrid(&state.grid, ARENA_SIZE, ARENA_SIZE, GRID_CELL_SIZE);
+    state.points = malloc(sizeof(Vector2) * MAX_QUERIES);
+
+    printf("{\n  \"benchmark\": \"crazy_bench\",\n  \"steer_batch_width\": %i,\n  \"results\": [", GetSteerBatchWidth());
+    bool isFirst = true;
+
+    for (size_t k = 0; k < sizeof(KERNELS) / sizeof(KERNELS[0]); k++) {
+        const Kernel* kernel = &KERNELS[k];
+        if (filter != NULL && strstr(kernel->name, filter) == NULL) continue;
+
+        for (size_t c = 0; c < sizeof(ENTITY_COUNTS) / sizeof(ENTITY_COUNTS[0]); c++) {
+            int count = ENTITY_COUNTS[c];
+            if (count > maxEntities) break;
+
+            // Steering moves the rats, so each kernel starts from the same layout and repeats are timed together
+            populate(&state, count);
+            kernel->run(&state);
+
+            int repeats = 1;
+            for (;;) {
+                double start = now();
+                for (int r = 0; r < repeats; r++) kernel->run(&state);
+                if (now() - start >= MIN_SAMPLE_SECONDS) break;
+                repeats *= 2;
+            }
+
+            double samples[SAMPLE_COUNT];
+            for (int s = 0; s < SAMPLE_COUNT; s++) {
+                populate(&state, count);
+                double start = now();
+                for (int r = 0; r < repeats; r++) kernel->run(&state);
+                samples[s] = (now() - start) / repeats;
+            }
+            qsort(samples, SAMPLE_COUNT, sizeof(double), compareDoubles);
+
+            int work = kernel->perQuery ? state.queryCount : count;
+            double median = samples[SAMPLE_COUNT / 2];
+            printf("%s\n    { \"kernel\": \"%s\", \"entities\": %i, \"operations\": %i, \"repeats\": %i, "
+                   "\"ns_per_entity\": %.3f, \"ns_min\": %.3f, \"ns_max\": %.3f }",
+                   isFirst ? "" : ",", kernel->name, count, work, repeats,
+                   median * 1e9 / work, samples[0] * 1e9 / work, samples[SAMPLE_COUNT - 1] * 1e9 / work);
+            fprintf(stderr, "%-18s %7i %10.2f ns/entity\n", kernel->name, count, median * 1e9 / work);
+            isFirst = false;
+        }
+    }
+    printf("\n  ]\n}\n");
+
+    free(state.points);
+    UnloadSpatialGrid(&state.grid);
+    UnloadRatStore(&state.store);
+    return 0;
+}
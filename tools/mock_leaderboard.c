@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+// A local stand-in for lcv2-server, for trying leaderboard submission without touching the real board
+// Usage: crazy_mock_leaderboard [--port <port>] [--fail <status> <count>]
+// GET /authorize answers with a new GUID and POST /entry/upload prints the submitted entry. With --fail, the first
+// <count> requests are answered with <status> instead, to watch the game retry or drop them.
+
+#define DEFAULT_PORT 8787
+#define MAX_REQUEST 8192
+
+static int guidCount = 0;
+
+static void respond(int client, int status, const char* body) {
+    char response[512];
+    int length = snprintf(response, sizeof(response),
+                          "HTTP/1.1 %i Mock\r\nContent-Type: text/plain\r\nContent-Length: %zu\r\n"
+                          "Access-Control-Allow-Origin: *\r\nAccess-Control-Allow-Headers: Content-Type\r\nConnection: close\r\n\r\n%s",
+                          status, strlen(body), body);
+    send(client, response, (size_t) length, 0);
+}
+
+// Copies the value of a form field from a multipart body
+static void readField(const char* body, const char* name, char* value, size_t size) {
+    char marker[64];
+    snprintf(marker, sizeof(marker), "name=\"%s\"", name);
+    value[0] = '\0';
+    const char* field = strstr(body, marker);
+    if (field == NULL || (field = strstr(field, "\n\n")) == NULL) return;
+    field += 2;
+
+    size_t length = strcspn(field, "\r\n");
+    if (length >= size) length = size - 1;
+    memcpy(value, field, length);
+    value[length] = '\0';
+}
+
+// Reads the headers, then as much of the body as Content-Length says
+static int readRequest(int client, char* request) {
+    int received = 0;
+    char* body = NULL;
+    long contentLength = 0;
+    while (received < MAX_REQUEST - 1) {
+        ssize_t count = recv(client, request + received, (size_t) (MAX_REQUEST - 1 - received), 0);
+        if (count <= 0) break;
+        received += (int) count;
+        request[received] = '\0';
+
+        if (body == NULL && (body = strstr(request, "\r\n\r\n")) != NULL) {
+            body += 4;
+            const char* header = strstr(request, "Content-Length:");
+            if (header != NULL) contentLength = strtol(header + 15, NULL, 10);
+        }
+        if (body != NULL && request + received - body >= contentLength) break;
+    }
+    return received;
+}
+
+int main(int argc, char** argv) {
+    int port = DEFAULT_PORT;
+    int failStatus = 0;
+    int failCount = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--fail") == 0 && i + 2 < argc) {
+            failStatus = atoi(argv[++i]);
+            failCount = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [--port <port>] [--fail <status> <count>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    int server = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    struct sockaddr_in address = { .sin_family = AF_INET, .sin_port = htons((uint16_t) port), .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    if (server < 0 || bind(server, (struct sockaddr*) &address, sizeof(address)) != 0 || listen(server, 8) != 0) {
+        perror("mock leaderboard");
+        return 1;
+    }
+    printf("Mock leaderboard on http://127.0.0.1:%i\n", port);
+    fflush(stdout);
+
+    static char request[MAX_REQUEST];
+    for (;;) {
+        int client = accept(server, NULL, NULL);
+        if (client < 0) continue;
+        if (readRequest(client, request) <= 0) {
+            close(client);
+            continue;
+        }
+
+        char method[8] = "";
+        char path[128] = "";
+        sscanf(request, "%7s %127s", method, path);
+        if (strcmp(method, "OPTIONS") == 0) {
+            respond(client, 204, "");
+        } else if (failCount > 0) {
+            failCount--;
+            printf("%s %s -> %i\n", method, path, failStatus);
+            respond(client, failStatus, "mock failure");
+        } else if (strcmp(method, "GET") == 0 && strcmp(path, "/authorize") == 0) {
+            char guid[32];
+            snprintf(guid, sizeof(guid), "mock-guid-%i", ++guidCount);
+            printf("GET /authorize -> %s\n", guid);
+            respond(client, 200, guid);
+        } else if (strcmp(method, "POST") == 0 && strcmp(path, "/entry/upload") == 0) {
+            char username[64], score[16], guid[64];
+            const char* body = strstr(request, "\r\n\r\n");
+            body = body != NULL ? body + 4 : "";
+            readField(body, "username", username, sizeof(username));
+            readField(body, "score", score, sizeof(score));
+            readField(body, "userGuid", guid, sizeof(guid));
+            printf("POST /entry/upload -> %s scored %s (%s)\n", username, score, guid);
+            respond(client, 200, "");
+        } else {
+            printf("%s %s -> 404\n", method, path);
+            respond(client, 404, "not found");
+        }
+        fflush(stdout);
+        close(client);
+    }
+}
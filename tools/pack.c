@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "raylib.h"
+#include "sprites.h"
+#include "archive.h"
+
+// Packs the textures and audio of a resources directory into one archive that the game maps at startup
+// Usage: crazy_pack <resources directory> <output file>
+// Images are stored as decoded RGBA, with the mip chain when they are drawn at changing sizes, so loading one is
+// a single upload straight from the mapped file. Sprites and baked textures go in through their baked files only. Audio keeps its file bytes for streaming; WAV files also get
+// 16-bit samples a sound can use as-is, in place when the file already holds them.
+
+#define MAX_ENTRIES 128
+#define PACKED_FILE_TYPES ".png;.wav;.mp3;.ogg;.flac"
+
+typedef struct {
+    ArchiveEntry entry;
+    unsigned char* payload;
+} PackedEntry;
+
+static PackedEntry packed[MAX_ENTRIES];
+static int packedCount = 0;
+
+static uint16_t readU16(const unsigned char* data) {
+    return (uint16_t) (data[0] | data[1] << 8);
+}
+
+static uint32_t readU32(const unsigned char* data) {
+    return (uint32_t) data[0] | (uint32_t) data[1] << 8 | (uint32_t) data[2] << 16 | (uint32_t) data[3] << 24;
+}
+
+// Offset of the sample data when the file is plain 16-bit PCM, which is exactly what LoadWave would produce
+static uint32_t findPcm16Samples(const unsigned char* data, int size) {
+    if (size < 12 || memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "WAVE", 4) != 0) return 0;
+
+    bool isPcm16 = false;
+    for (int offset = 12; offset + 8 <= size;) {
+        uint32_t chunkSize = readU32(data + offset + 4);
+        if (memcmp(data + offset, "fmt ", 4) == 0 && offset + 24 <= size) {
+            isPcm16 = readU16(data + offset + 8) == 1 && readU16(data + offset + 22) == 16;
+        } else if (memcmp(data + offset, "data", 4) == 0) {
+            return isPcm16 ? (uint32_t) offset + 8 : 0;
+        }
+        offset += 8 + chunkSize + (chunkSize & 1);
+    }
+    return 0;
+}
+
+static PackedEntry* addEntry(const char* name, ArchiveEntryKind kind) {
+    if (packedCount == MAX_ENTRIES || strlen(name) >= ARCHIVE_NAME_SIZE) {
+        TraceLog(LOG_ERROR, "PACK: [%s] Does not fit in the archive", name);
+        return NULL;
+    }
+    PackedEntry* packedEntry = &packed[packedCount++];
+    packedEntry->entry = (ArchiveEntry) { .kind = kind };
+    strcpy(packedEntry->entry.name, name);
+    return packedEntry;
+}
+
+static bool packImage(const char* path, const char* name, bool isMipmapped) {
+    Image image = LoadImage(path);
+    if (image.data == NULL) return false;
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    if (isMipmapped) ImageMipmaps(&image);
+
+    uint64_t size = 0;
+    for (int level = 0, w = image.width, h = image.height; level < image.mipmaps; level++) {
+        size += (uint64_t) GetPixelDataSize(w, h, image.format);
+        w = w > 1 ? w / 2 : 1;
+        h = h > 1 ? h / 2 : 1;
+    }
+
+    PackedEntry* packedEntry = addEntry(name, ARCHIVE_IMAGE);
+    if (packedEntry == NULL) return false;
+    packedEntry->payload = image.data;
+    packedEntry->entry.width = (uint32_t) image.width;
+    packedEntry->entry.height = (uint32_t) image.height;
+    packedEntry->entry.format = (uint32_t) image.format;
+    packedEntry->entry.mipmaps = (uint32_t) image.mipmaps;
+    packedEntry->entry.size = size;
+    return true;
+}
+
+static bool packAudio(const char* path, const char* name) {
+    int fileSize = 0;
+    unsigned char* file = LoadFileData(path, &fileSize);
+    if (file == NULL) return false;
+
+    PackedEntry* packedEntry = addEntry(name, ARCHIVE_AUDIO);
+    if (packedEntry == NULL) return false;
+    ArchiveEntry* entry = &packedEntry->entry;
+    entry->fileSize = (uint64_t) fileSize;
+    entry->size = (uint64_t) fileSize;
+    packedEntry->payload = file;
+    if (!IsFileExtension(path, ".wav")) return true;
+
+    Wave wave = LoadWaveFromMemory(".wav", file, fileSize);
+    if (wave.data == NULL) return false;
+    entry->frameCount = wave.frameCount;
+    entry->sampleRate = wave.sampleRate;
+    entry->sampleSize = wave.sampleSize;
+    entry->channels = wave.channels;
+    entry->sampleOffset = findPcm16Samples(file, fileSize);
+
+    // Anything else, such as 24-bit, float or ADPCM, is decoded now and appended after the file
+    if (entry->sampleOffset == 0) {
+        size_t sampleBytes = (size_t) wave.frameCount * wave.channels * wave.sampleSize / 8;
+        entry->sampleOffset = (uint32_t) ((fileSize + ARCHIVE_SAMPLE_ALIGNMENT - 1) / ARCHIVE_SAMPLE_ALIGNMENT * ARCHIVE_SAMPLE_ALIGNMENT);
+        entry->size = entry->sampleOffset + sampleBytes;
+        packedEntry->payload = MemRealloc(file, (unsigned int) entry->size);
+        memset(packedEntry->payload + fileSize, 0, entry->sampleOffset - fileSize);
+        memcpy(packedEntry->payload + entry->sampleOffset, wave.data, sampleBytes);
+    }
+    UnloadWave(wave);
+    return true;
+}
+
+static int comparePaths(const void* a, const void* b) {
+    return strcmp(*(char* const*) a, *(char* const*) b);
+}
+
+#define BAKED_TEXTURE_FILE(file, bakeScale, isMipmapped) file,
+#define BAKED_TEXTURE_MIPMAPPED(file, bakeScale, isMipmapped) isMipmapped,
+static const char* bakedFiles[] = { BAKED_TEXTURE_LIST(BAKED_TEXTURE_FILE) };
+static const bool isBakedMipmapped[] = { BAKED_TEXTURE_LIST(BAKED_TEXTURE_MIPMAPPED) };
+#undef BAKED_TEXTURE_FILE
+#undef BAKED_TEXTURE_MIPMAPPED
+
+#define BAKED_FILE_COUNT (int) (sizeof(bakedFiles) / sizeof(bakedFiles[0]))
+
+static bool isSpriteFile(const char* name) {
+    for (int i = 0; i < SPRITE_COUNT; i++) {
+        if (strcmp(name, GetSpriteFileName(i)) == 0) return true;
+    }
+    return false;
+}
+
+static bool isBakedFile(const char* input, const char* name) {
+    for (int i = 0; i < BAKED_FILE_COUNT; i++) {
+        if (strcmp(name, bakedFiles[i]) == 0) return FileExists(TextFormat("%s/baked/%s", input, name));
+    }
+    return false;
+}
+
+static bool writeArchive(const char* output) {
+    FILE* file = fopen(output, "wb");
+    if (file == NULL) return false;
+
+    uint64_t offset = sizeof(ArchiveHeader) + sizeof(ArchiveEntry) * packedCount;
+    for (int i = 0; i < packedCount; i++) {
+        offset = (offset + ARCHIVE_ALIGNMENT - 1) / ARCHIVE_ALIGNMENT * ARCHIVE_ALIGNMENT;
+        packed[i].entry.offset = offset;
+        offset += packed[i].entry.size;
+    }
+
+    ArchiveHeader header = { ARCHIVE_MAGIC, ARCHIVE_VERSION, (uint32_t) packedCount, 0 };
+    bool isWritten = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (int i = 0; isWritten && i < packedCount; i++) {
+        isWritten = fwrite(&packed[i].entry, sizeof(ArchiveEntry), 1, file) == 1;
+    }
+
+    static const unsigned char padding[ARCHIVE_ALIGNMENT];
+    for (int i = 0; isWritten && i < packedCount; i++) {
+        long position = ftell(file);
+        isWritten = fwrite(padding, 1, packed[i].entry.offset - position, file) == packed[i].entry.offset - position
+                    && fwrite(packed[i].payload, 1, packed[i].entry.size, file) == packed[i].entry.size;
+    }
+    return fclose(file) == 0 && isWritten;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <resources directory> <output file>\n", argv[0]);
+        return 1;
+    }
+    const char* input = argv[1];
+    const char* output = argv[2];
+
+    int atlasPages = 0;
+    char* table = LoadFileText(TextFormat("%s/baked/%s", input, ATLAS_TABLE_FILE));
+    if (table != NULL) {
+        sscanf(table, "pages %d", &atlasPages);
+        UnloadFileText(table);
+    }
+    for (int page = 0; page < atlasPages; page++) {
+        const char* name = TextFormat("baked/atlas%i.png", page);
+        if (!packImage(TextFormat("%s/%s", input, name), name, true)) return 1;
+    }
+    for (int i = 0; i < BAKED_FILE_COUNT; i++) {
+        const char* name = TextFormat("baked/%s", bakedFiles[i]);
+        const char* path = TextFormat("%s/%s", input, name);
+        if (FileExists(path) && !packImage(path, name, isBakedMipmapped[i])) return 1;
+    }
+
+    // Without an atlas the game loads each sprite's own file, so those are packed instead
+    FilePathList files = LoadDirectoryFilesEx(input, PACKED_FILE_TYPES, false);
+    qsort(files.paths, files.count, sizeof(char*), comparePaths);
+    for (unsigned int i = 0; i < files.count; i++) {
+        const char* name = GetFileName(files.paths[i]);
+        if ((atlasPages > 0 && isSpriteFile(name)) || isBakedFile(input, name)) continue;
+
+        bool isPacked = IsFileExtension(name, ".png") ? packImage(files.paths[i], name, false) : packAudio(files.paths[i], name);
+        if (!isPacked) {
+            TraceLog(LOG_ERROR, "PACK: [%s] Could not be packed", files.paths[i]);
+            return 1;
+        }
+    }
+    UnloadDirectoryFiles(files);
+
+    bool isWritten = writeArchive(output);
+    for (int i = 0; i < packedCount; i++) MemFree(packed[i].payload);
+    if (!isWritten) {
+        TraceLog(LOG_ERROR, "PACK: [%s] Could not be written", output);
+        return 1;
+    }
+    TraceLog(LOG_INFO, "PACK: [%s] Packed %i entries", output, packedCount);
+    return 0;
+}